@@ -35,36 +35,49 @@ int main() {
     election.setElectionStatus(true);
     std::cout << "Election started!\n\n";
     
-    // Simulate real-time vote updates from different precincts
+    // Simulate real-time precinct reports; each one is applied as a unit,
+    // so results never show a precinct with only some candidates counted
     std::cout << "Simulating real-time vote updates...\n";
     
     // California precincts reporting
-    election.processVoteUpdate("California", "John Smith", 1250, "CA-P001");
-    election.processVoteUpdate("California", "Jane Doe", 980, "CA-P001");
-    election.processVoteUpdate("California", "Bob Johnson", 320, "CA-P001");
+    election.processPrecinctReport("California", "CA-P001", {
+        {"John Smith", 1250},
+        {"Jane Doe", 980},
+        {"Bob Johnson", 320}
+    });
     
-    election.processVoteUpdate("California", "John Smith", 890, "CA-P002");
-    election.processVoteUpdate("California", "Jane Doe", 1100, "CA-P002");
+    election.processPrecinctReport("California", "CA-P002", {
+        {"John Smith", 890},
+        {"Jane Doe", 1100}
+    });
     
     // Texas precincts reporting
-    election.processVoteUpdate("Texas", "Jane Doe", 1450, "TX-P001");
-    election.processVoteUpdate("Texas", "John Smith", 1200, "TX-P001");
-    election.processVoteUpdate("Texas", "Bob Johnson", 800, "TX-P001");
+    election.processPrecinctReport("Texas", "TX-P001", {
+        {"Jane Doe", 1450},
+        {"John Smith", 1200},
+        {"Bob Johnson", 800}
+    });
     
     // Florida precincts reporting
-    election.processVoteUpdate("Florida", "John Smith", 1100, "FL-P001");
-    election.processVoteUpdate("Florida", "Jane Doe", 1350, "FL-P001");
-    election.processVoteUpdate("Florida", "Alice Wilson", 450, "FL-P001");
+    election.processPrecinctReport("Florida", "FL-P001", {
+        {"John Smith", 1100},
+        {"Jane Doe", 1350},
+        {"Alice Wilson", 450}
+    });
     
     // New York precincts reporting
-    election.processVoteUpdate("New York", "John Smith", 980, "NY-P001");
-    election.processVoteUpdate("New York", "Jane Doe", 1200, "NY-P001");
-    election.processVoteUpdate("New York", "Bob Johnson", 600, "NY-P001");
+    election.processPrecinctReport("New York", "NY-P001", {
+        {"John Smith", 980},
+        {"Jane Doe", 1200},
+        {"Bob Johnson", 600}
+    });
     
     // Illinois precincts reporting
-    election.processVoteUpdate("Illinois", "John Smith", 850, "IL-P001");
-    election.processVoteUpdate("Illinois", "Jane Doe", 1100, "IL-P001");
-    election.processVoteUpdate("Illinois", "Alice Wilson", 380, "IL-P001");
+    election.processPrecinctReport("Illinois", "IL-P001", {
+        {"John Smith", 850},
+        {"Jane Doe", 1100},
+        {"Alice Wilson", 380}
+    });
     
     std::cout << "Initial vote updates processed.\n\n";
     
@@ -76,16 +89,22 @@ int main() {
     std::cout << "\nSimulating additional vote updates...\n";
     
     // More California votes
-    election.processVoteUpdate("California", "John Smith", 750, "CA-P003");
-    election.processVoteUpdate("California", "Jane Doe", 680, "CA-P003");
+    election.processPrecinctReport("California", "CA-P003", {
+        {"John Smith", 750},
+        {"Jane Doe", 680}
+    });
     
     // More Texas votes
-    election.processVoteUpdate("Texas", "Jane Doe", 920, "TX-P002");
-    election.processVoteUpdate("Texas", "John Smith", 850, "TX-P002");
+    election.processPrecinctReport("Texas", "TX-P002", {
+        {"Jane Doe", 920},
+        {"John Smith", 850}
+    });
     
     // More Florida votes
-    election.processVoteUpdate("Florida", "John Smith", 650, "FL-P002");
-    election.processVoteUpdate("Florida", "Jane Doe", 720, "FL-P002");
+    election.processPrecinctReport("Florida", "FL-P002", {
+        {"John Smith", 650},
+        {"Jane Doe", 720}
+    });
     
     std::cout << "Additional updates processed.\n\n";
     
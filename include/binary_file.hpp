@@ -0,0 +1,179 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Little-endian encoding and unbuffered file helpers shared by the
+ * write-ahead log and checkpoints
+ *
+ * The file functions wrap POSIX (or the Windows CRT equivalents) so that
+ * callers control exactly when data reaches stable storage.
+ */
+
+inline void putU32(std::vector<unsigned char>& out, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<unsigned char>(value >> shift));
+    }
+}
+
+inline void putU64(std::vector<unsigned char>& out, uint64_t value) {
+    for (int shift = 0; shift < 64; shift += 8) {
+        out.push_back(static_cast<unsigned char>(value >> shift));
+    }
+}
+
+inline void putString(std::vector<unsigned char>& out, const std::string& text) {
+    putU32(out, static_cast<uint32_t>(text.size()));
+    out.insert(out.end(), text.begin(), text.end());
+}
+
+inline uint32_t getU32(const unsigned char* in) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; --i) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+inline uint64_t getU64(const unsigned char* in) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+/**
+ * @brief Bounds-checked reader over an encoded buffer
+ *
+ * Every read throws std::runtime_error if it would run past the end.
+ */
+class ByteReader {
+public:
+    ByteReader(const unsigned char* data, size_t size) : data(data), size(size) {}
+
+    uint32_t u32() { need(4); uint32_t value = getU32(data + offset); offset += 4; return value; }
+    uint64_t u64() { need(8); uint64_t value = getU64(data + offset); offset += 8; return value; }
+    int64_t i64() { return static_cast<int64_t>(u64()); }
+
+    std::string string() {
+        uint32_t length = u32();
+        need(length);
+        std::string text(reinterpret_cast<const char*>(data + offset), length);
+        offset += length;
+        return text;
+    }
+
+    size_t remaining() const { return size - offset; }
+
+private:
+    const unsigned char* data;
+    size_t size;
+    size_t offset = 0;
+
+    void need(size_t bytes) const;
+};
+
+/**
+ * @brief Open a file for appending, creating it if needed
+ * @return A file descriptor, or -1 on failure
+ */
+int openAppendFile(const std::string& path);
+
+/**
+ * @brief Create or truncate a file for writing
+ * @return A file descriptor, or -1 on failure
+ */
+int openWriteFile(const std::string& path);
+
+/**
+ * @brief Cut a file down to the given length
+ */
+bool truncateFile(int fd, uint64_t length);
+
+/**
+ * @brief Write the whole buffer, retrying short writes
+ */
+bool writeFully(int fd, const unsigned char* data, size_t length);
+
+/**
+ * @brief Flush a file's data to stable storage (fdatasync, fsync on macOS, _commit on Windows)
+ */
+bool syncFile(int fd);
+
+/**
+ * @brief Close a file descriptor
+ */
+void closeFile(int fd);
+
+/**
+ * @brief Atomically replace target with source (both on the same filesystem)
+ */
+bool replaceFile(const std::string& source, const std::string& target);
+
+/**
+ * @brief Read a whole file
+ * @return False if the file cannot be opened
+ */
+bool readFile(const std::string& path, std::vector<unsigned char>& bytes);
+
+/**
+ * @brief A whole file mapped read-write into memory (mmap / MapViewOfFile)
+ *
+ * Writes go straight to the page cache, so they survive the process being
+ * killed; sync() is needed only to survive a power loss. Growing the file
+ * remaps it, which moves data(), so callers keep offsets rather than
+ * pointers.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Open or create a file and map all of it
+     * @param path The file
+     * @param minSize Grow the file to at least this many bytes (new bytes read as zero)
+     * @return The file's size before it was opened, 0 if it was created
+     * @throws std::runtime_error if the file cannot be opened or mapped
+     */
+    size_t open(const std::string& path, size_t minSize);
+
+    /**
+     * @brief Grow the file and remap it
+     * @throws std::runtime_error on failure
+     */
+    void resize(size_t newSize);
+
+    /**
+     * @brief Write a byte range back to stable storage
+     * @return False if the sync failed
+     */
+    bool sync(size_t offset, size_t length);
+
+    /**
+     * @brief Unmap and close the file
+     */
+    void close();
+
+    unsigned char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    unsigned char* bytes = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fd = -1;
+#endif
+
+    void map();
+    void unmap();
+};
@@ -0,0 +1,150 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <cstdint>
+#include "vote_history.hpp"
+
+class WriteAheadLog;
+
+/**
+ * @brief A candidate as stored in a checkpoint
+ */
+struct CheckpointCandidate {
+    std::string name;
+    std::string party;
+    std::string id;
+};
+
+/**
+ * @brief A district, its assignments and its tallies as stored in a checkpoint
+ */
+struct CheckpointDistrict {
+    std::string name;
+    std::string id;
+    uint64_t candidateCount = 0;
+    std::vector<uint32_t> assigned;  // Candidate handle per tree index, in assignment order
+    std::vector<int64_t> values;     // Votes per tree index
+};
+
+/**
+ * @brief A precinct as stored in a checkpoint, in PrecinctIndex handle order
+ */
+struct CheckpointPrecinct {
+    uint32_t district;
+    uint32_t precinctId;  // Interned id in the checkpoint's history
+};
+
+/**
+ * @brief Complete tally state at one point in the update stream
+ *
+ * Captured by VoteManager::captureCheckpoint on the writing thread. The
+ * tallies are copied and the history is a prefix shared with the live
+ * one, so it can be serialized on another thread while updates continue.
+ */
+struct CheckpointData {
+    uint64_t walSequence = 0;   // Last write-ahead log record included
+    uint64_t tallyVersion = 0;
+    std::vector<CheckpointCandidate> candidates;
+    std::vector<CheckpointDistrict> districts;
+    VoteHistory history;        // history.size() is the history offset of the checkpoint
+    std::vector<CheckpointPrecinct> precincts;  // Every known precinct, reported or not
+};
+
+/**
+ * @brief Write a checkpoint file atomically
+ * @param path The checkpoint file; replaced only once the new one is synced
+ * @param data The state to write
+ * @throws std::runtime_error if the file cannot be written
+ *
+ * The file is [u32 magic][u32 format version][body][u32 CRC32C of
+ * everything before it], little-endian. It is written to path + ".tmp",
+ * synced and then renamed over path, so a crash leaves either the old or
+ * the new checkpoint, never a mix.
+ */
+void writeCheckpointFile(const std::string& path, const CheckpointData& data);
+
+/**
+ * @brief Read a checkpoint file
+ * @throws std::runtime_error if the file is missing, truncated or fails its checksum
+ */
+CheckpointData readCheckpointFile(const std::string& path);
+
+/**
+ * @brief Background thread that writes checkpoints
+ *
+ * submit() hands over captured state and returns at once; the thread
+ * encodes, writes and syncs it. If several are submitted while one is
+ * being written, only the newest is written next.
+ *
+ * With a write-ahead log attached, each checkpoint is held back until the
+ * log is durable up to the checkpoint's sequence. Otherwise a crash could
+ * leave a checkpoint ahead of the log, and the reopened log would reuse
+ * sequence numbers the checkpoint already covers.
+ */
+class CheckpointWriter {
+public:
+    /**
+     * @brief Start the writer thread
+     * @param path The checkpoint file to keep replacing
+     * @param wal The log the checkpoints' sequences refer to, or null; must outlive the writer
+     */
+    explicit CheckpointWriter(const std::string& path, WriteAheadLog* wal = nullptr);
+
+    /**
+     * @brief Write any queued checkpoint, then stop the thread
+     */
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    /**
+     * @brief Queue a checkpoint, replacing one that has not started yet
+     */
+    void submit(std::shared_ptr<const CheckpointData> data);
+
+    /**
+     * @brief Block until every submitted checkpoint is written
+     * @throws std::runtime_error if the last write failed
+     */
+    void wait();
+
+    /**
+     * @brief Get the number of checkpoints written so far
+     */
+    uint64_t getWrittenCount() const;
+
+    /**
+     * @brief Get the write-ahead log sequence of the last checkpoint written
+     */
+    uint64_t getWrittenSequence() const;
+
+    /**
+     * @brief Get the checkpoint file path
+     */
+    const std::string& getPath() const { return path; }
+
+private:
+    std::string path;
+    WriteAheadLog* wal;
+
+    mutable std::mutex mutex;
+    std::condition_variable workReady;
+    std::condition_variable workDone;
+    std::shared_ptr<const CheckpointData> queued;
+    bool writing = false;
+    bool stopping = false;
+    uint64_t writtenCount = 0;
+    uint64_t writtenSequence = 0;
+    std::string error;
+    std::thread worker;
+
+    /**
+     * @brief Writer thread body
+     */
+    void writeLoop();
+};
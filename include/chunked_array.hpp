@@ -0,0 +1,162 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <cstddef>
+#include <utility>
+
+/**
+ * @brief Unbounded array in fixed-size chunks whose elements never move
+ *
+ * Element i lives in chunk i >> ChunkBits. Chunks are found through a
+ * two-level directory: a fixed top level of kMaxPages page pointers, each
+ * page holding kPageChunks chunk pointers. Pages and chunks are allocated
+ * the first time an index inside them is written and installed with a
+ * CAS, so growing never copies anything and never takes a lock. The worst
+ * case for slot() is one page plus one chunk allocation.
+ *
+ * Any number of threads may call slot() concurrently for distinct
+ * indices. A reader may use operator[] on any index whose write it has
+ * synchronized with; references stay valid until the array is destroyed.
+ */
+template <typename T, size_t ChunkBits = 12>
+class ChunkedArray {
+public:
+    static constexpr size_t kChunkSize = size_t(1) << ChunkBits;
+    static constexpr size_t kPageBits = 10;
+    static constexpr size_t kPageChunks = size_t(1) << kPageBits;
+    static constexpr size_t kMaxPages = 1024;
+
+    ChunkedArray() : pages(new std::atomic<Page*>[kMaxPages]) {
+        for (size_t p = 0; p < kMaxPages; ++p) {
+            pages[p].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~ChunkedArray() {
+        release();
+    }
+
+    /**
+     * @brief Deep copy; the source must not be written concurrently
+     */
+    ChunkedArray(const ChunkedArray& other) : ChunkedArray() {
+        for (size_t p = 0; p < kMaxPages; ++p) {
+            const Page* page = other.pages[p].load(std::memory_order_acquire);
+            if (!page) {
+                continue;
+            }
+            for (size_t c = 0; c < kPageChunks; ++c) {
+                const T* chunk = page->chunks[c].load(std::memory_order_acquire);
+                if (chunk) {
+                    T* copy = chunkAt(((p << kPageBits) | c) << ChunkBits);
+                    std::copy(chunk, chunk + kChunkSize, copy);
+                }
+            }
+        }
+    }
+
+    ChunkedArray(ChunkedArray&& other) noexcept : pages(std::move(other.pages)) {}
+
+    ChunkedArray& operator=(ChunkedArray other) noexcept {
+        release();
+        pages = std::move(other.pages);
+        return *this;
+    }
+
+    /**
+     * @brief Get element i for writing, allocating its chunk if needed
+     * @throws std::length_error past kMaxPages * kPageChunks * kChunkSize elements
+     */
+    T& slot(size_t i) {
+        return chunkAt(i)[i & (kChunkSize - 1)];
+    }
+
+    /**
+     * @brief Read element i; its chunk must exist
+     */
+    const T& operator[](size_t i) const {
+        const Page* page = pages[i >> (ChunkBits + kPageBits)].load(std::memory_order_acquire);
+        const T* chunk = page->chunks[(i >> ChunkBits) & (kPageChunks - 1)].load(std::memory_order_acquire);
+        return chunk[i & (kChunkSize - 1)];
+    }
+
+    /**
+     * @brief Allocate every chunk covering indices [first, last) ahead of time
+     *
+     * Afterwards slot() cannot throw for those indices.
+     * @throws std::length_error, before allocating anything, past the capacity
+     */
+    void preallocate(size_t first, size_t last) {
+        if (last > kMaxPages * kPageChunks * kChunkSize) {
+            throw std::length_error("ChunkedArray capacity exceeded");
+        }
+        for (size_t i = first & ~(kChunkSize - 1); i < last; i += kChunkSize) {
+            chunkAt(i);
+        }
+    }
+
+    void preallocate(size_t n) {
+        preallocate(0, n);
+    }
+
+private:
+    struct Page {
+        std::atomic<T*> chunks[kPageChunks];
+
+        Page() {
+            for (auto& chunk : chunks) {
+                chunk.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    std::unique_ptr<std::atomic<Page*>[]> pages;
+
+    T* chunkAt(size_t i) {
+        size_t pageIndex = i >> (ChunkBits + kPageBits);
+        if (pageIndex >= kMaxPages) {
+            throw std::length_error("ChunkedArray capacity exceeded");
+        }
+        Page* page = install(pages[pageIndex], [] { return new Page(); }, [](Page* p) { delete p; });
+        return install(page->chunks[(i >> ChunkBits) & (kPageChunks - 1)],
+                       [] { return new T[kChunkSize]; }, [](T* c) { delete[] c; });
+    }
+
+    /**
+     * @brief Return the pointer in slot, installing a fresh allocation if it is null
+     *
+     * If two threads race, the loser frees its allocation and uses the winner's.
+     */
+    template <typename U, typename Make, typename Free>
+    static U* install(std::atomic<U*>& slot, Make make, Free free) {
+        U* current = slot.load(std::memory_order_acquire);
+        if (current) {
+            return current;
+        }
+        U* fresh = make();
+        if (slot.compare_exchange_strong(current, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return fresh;
+        }
+        free(fresh);
+        return current;
+    }
+
+    void release() {
+        if (!pages) {
+            return;
+        }
+        for (size_t p = 0; p < kMaxPages; ++p) {
+            Page* page = pages[p].load(std::memory_order_relaxed);
+            if (!page) {
+                continue;
+            }
+            for (auto& chunk : page->chunks) {
+                delete[] chunk.load(std::memory_order_relaxed);
+            }
+            delete page;
+        }
+        pages.reset();
+    }
+};
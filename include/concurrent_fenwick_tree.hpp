@@ -0,0 +1,149 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "fenwick_tree.hpp"
+
+/**
+ * @brief Lock-free Fenwick Tree over atomic counters
+ *
+ * Selected by instantiating BasicFenwickTree with a std::atomic counter.
+ * update() does a relaxed fetch_add on each node of its walk, so any
+ * number of threads may update concurrently without locks and no update
+ * is ever lost.
+ *
+ * Read guarantee: a query running alongside writers reads each node
+ * atomically, but not all nodes at the same instant, so the result is not
+ * linearizable. For each concurrent update it may include anywhere from
+ * none to all of that update's nodes. If every delta is non-negative, a
+ * prefix query is bounded below by the sum of all updates that finished
+ * before it started, and above by the sum of all updates that started
+ * before it finished. Once writers are quiescent (joined, or synchronized
+ * with the reader) every query is exact.
+ *
+ * reset() and toValues() are meant for quiescent periods only.
+ */
+template <typename T, typename Index>
+class BasicFenwickTree<std::atomic<T>, Index> {
+    static_assert(std::is_integral<T>::value, "Fenwick Tree counters must be integers");
+    static_assert(std::is_unsigned<Index>::value, "Fenwick Tree indices must be unsigned");
+
+public:
+    using value_type = T;
+    using index_type = Index;
+
+private:
+    std::unique_ptr<std::atomic<T>[]> tree;
+    Index size;
+
+    static Index lsb(Index x) { return static_cast<Index>(x & (~x + 1)); }
+
+public:
+    /**
+     * @brief Construct a Fenwick Tree with given size
+     * @param n The size of the tree
+     */
+    explicit BasicFenwickTree(Index n) : tree(new std::atomic<T>[static_cast<size_t>(n) + 1]), size(n) {
+        if (n == 0) {
+            throw std::invalid_argument("Fenwick Tree size must be greater than 0");
+        }
+        for (size_t i = 0; i <= size; ++i) {
+            tree[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Update the value at index i by adding delta; safe from any thread
+     * @param i The index to update (1-based indexing)
+     * @param delta The value to add
+     *
+     * Time complexity: O(log n) atomic adds
+     */
+    void update(Index i, T delta) {
+        if (i == 0 || i > size) {
+            throw std::out_of_range("Index out of range for Fenwick Tree update");
+        }
+        for (size_t node = i; node <= size; node += lsb(static_cast<Index>(node))) {
+            tree[node].fetch_add(delta, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Get the prefix sum from index 1 to i (see class notes on consistency)
+     * @param i The end index (1-based indexing)
+     */
+    T query(Index i) const {
+        if (i == 0) return 0;
+        if (i > size) {
+            throw std::out_of_range("Index out of range for Fenwick Tree query");
+        }
+
+        T sum = 0;
+        while (i > 0) {
+            sum += tree[i].load(std::memory_order_relaxed);
+            i -= lsb(i);
+        }
+        return sum;
+    }
+
+    /**
+     * @brief Get the sum of values in range [left, right]
+     */
+    T rangeQuery(Index left, Index right) const {
+        if (left > right) {
+            throw std::invalid_argument("Left boundary must be <= right boundary");
+        }
+        if (left == 0 || right > size) {
+            throw std::out_of_range("Range boundaries out of range for Fenwick Tree");
+        }
+        return static_cast<T>(query(right) - query(left - 1));
+    }
+
+    /**
+     * @brief Get the value at a specific index
+     */
+    T getValue(Index i) const {
+        if (i == 0 || i > size) {
+            throw std::out_of_range("Index out of range for Fenwick Tree getValue");
+        }
+        return rangeQuery(i, i);
+    }
+
+    /**
+     * @brief Get the current size of the tree
+     */
+    Index getSize() const { return size; }
+
+    /**
+     * @brief Reset all values to zero (writers must be quiescent)
+     */
+    void reset() {
+        for (size_t i = 0; i <= size; ++i) {
+            tree[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Extract all point values (writers must be quiescent)
+     *
+     * Time complexity: O(n)
+     */
+    std::vector<T> toValues() const {
+        std::vector<T> values(size);
+        for (size_t i = 1; i <= size; ++i) {
+            values[i - 1] = tree[i].load(std::memory_order_relaxed);
+        }
+        for (size_t i = size; i >= 1; --i) {
+            size_t parent = i + lsb(static_cast<Index>(i));
+            if (parent <= size) {
+                values[parent - 1] -= values[i - 1];
+            }
+        }
+        return values;
+    }
+};
+
+/**
+ * @brief The default concurrent tree: 64-bit atomic counters, size_t indices
+ */
+using ConcurrentFenwickTree = BasicFenwickTree<std::atomic<int64_t>, size_t>;
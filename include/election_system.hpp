@@ -2,7 +2,39 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <unordered_map>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 #include "vote_manager.hpp"
+#include "mpsc_queue.hpp"
+
+/**
+ * @brief Counters for the asynchronous ingestion path
+ */
+struct IngestionStats {
+    uint64_t submitted = 0;          // Updates accepted by submitVoteUpdate
+    uint64_t dropped = 0;            // Updates refused because the queue was full
+    uint64_t applied = 0;            // Updates applied to the tallies
+    uint64_t failed = 0;             // Updates the vote manager rejected
+    uint64_t batches = 0;            // Drained batches
+    size_t queueDepth = 0;           // Updates waiting right now
+    size_t maxQueueDepth = 0;        // Deepest queue seen by the applier
+    uint64_t lastDrainLatencyNs = 0; // Oldest enqueue to applied, last batch
+    uint64_t maxDrainLatencyNs = 0;  // Worst batch so far
+};
+
+/**
+ * @brief One vote update in a batch passed to processVoteUpdates
+ */
+struct VoteUpdateRequest {
+    std::string districtName;
+    std::string candidateName;
+    int64_t voteCount;
+    std::string precinctId;
+};
 
 /**
  * @brief High-level election management system
@@ -18,15 +50,96 @@ private:
     std::unique_ptr<VoteManager> voteManager;
     std::string electionName;
     std::string electionDate;
-    bool isActive;
+    std::atomic<bool> isActive;
+    
+    // Guards voteManager once the applier thread is running
+    mutable std::mutex managerMutex;
+    
+    // A vote update resolved to handles, waiting for the applier
+    struct PendingVoteUpdate {
+        DistrictHandle district;
+        CandidateHandle candidate;
+        int64_t voteCount;
+        std::string precinctId;
+        std::chrono::steady_clock::time_point enqueued;
+    };
+    
+    // Asynchronous ingestion: producers push, one applier thread drains.
+    // queueUsers counts threads between their applierRunning check and
+    // their last use of ingestQueue; the applier waits for it to reach zero
+    // after a stop, so the queue is never drained early or replaced in use.
+    std::unique_ptr<MpscQueue<PendingVoteUpdate>> ingestQueue;
+    std::thread applier;
+    std::atomic<bool> applierRunning{false};
+    mutable std::atomic<size_t> queueUsers{0};
+    std::atomic<uint64_t> attemptedCount{0};  // Pushes started; each ends applied, failed or dropped
+    std::atomic<uint64_t> submittedCount{0};
+    std::atomic<uint64_t> droppedCount{0};
+    std::atomic<uint64_t> appliedCount{0};
+    std::atomic<uint64_t> failedCount{0};
+    std::atomic<uint64_t> batchCount{0};
+    std::atomic<size_t> maxQueueDepth{0};
+    std::atomic<uint64_t> lastDrainLatencyNs{0};
+    std::atomic<uint64_t> maxDrainLatencyNs{0};
+    
+    // Signalled whenever updates are applied, failed or dropped
+    std::mutex progressMutex;
+    std::condition_variable progressMade;
+    
+    /**
+     * @brief Register as a queue user if ingestion is running
+     * @return False, without registering, if the applier is stopped or stopping
+     */
+    bool enterQueue() const;
+    
+    /**
+     * @brief Wake flushIngestion after the counters moved
+     */
+    void notifyProgress();
+    
+    /**
+     * @brief Applier thread body: drain the queue in batches until stopped
+     */
+    void applyLoop();
+    
+    /**
+     * @brief Apply one drained batch under the manager lock
+     */
+    void applyBatch(std::vector<PendingVoteUpdate>& batch);
+
+    // Display name -> handle indexes, built once in setupElection
+    std::unordered_map<std::string, DistrictHandle> districtsByName;
+    std::unordered_map<std::string, CandidateHandle> candidatesByName;
+
+    /**
+     * @brief Resolve a district name to its handle
+     * @return The district handle, or kInvalidHandle if not found
+     */
+    DistrictHandle findDistrict(const std::string& districtName) const;
+    
+    /**
+     * @brief Resolve a candidate name to its handle
+     * @return The candidate handle, or kInvalidHandle if not found
+     */
+    CandidateHandle findCandidate(const std::string& candidateName) const;
 
 public:
     /**
      * @brief Construct the election system
      * @param name The name of the election
      * @param date The date of the election
+     * @param storage The storage backend for vote tallies
      */
-    ElectionSystem(const std::string& name, const std::string& date);
+    ElectionSystem(const std::string& name, const std::string& date,
+                   TallyStorage storage = TallyStorage::Adaptive);
+    
+    /**
+     * @brief Stops the applier thread, applying anything still queued
+     */
+    ~ElectionSystem();
+    
+    ElectionSystem(const ElectionSystem&) = delete;
+    ElectionSystem& operator=(const ElectionSystem&) = delete;
     
     /**
      * @brief Set up the election structure
@@ -44,13 +157,93 @@ public:
      * @param candidateName The candidate name
      * @param voteCount The number of votes
      * @param precinctId The precinct identifier
-     * @return True if the update was successful
+     * @return True if the update was applied; false for unknown names or an
+     *         inactive election
+     * @throws std::runtime_error if the write-ahead log or tally file fails
      */
     bool processVoteUpdate(const std::string& districtName,
                           const std::string& candidateName,
                           int64_t voteCount,
                           const std::string& precinctId);
     
+    /**
+     * @brief Process a whole precinct report or feed batch
+     * @param updates The updates, in any order
+     * @return One status per update, in the same order
+     * 
+     * Takes the manager lock and the clock once, resolves each name once,
+     * reserves history for the batch and applies the valid updates with one
+     * tree pass per district. Invalid updates are skipped, not rolled back.
+     * If the write-ahead log or tally file fails for a district, that
+     * district's updates report VoteStatus::StorageError and the other
+     * districts still apply.
+     */
+    std::vector<VoteStatus> processVoteUpdates(const std::vector<VoteUpdateRequest>& updates);
+    
+    /**
+     * @brief Apply every candidate's votes from one precinct as a unit
+     * @param districtName The district the precinct belongs to
+     * @param precinctId The precinct identifier
+     * @param candidateVotes (candidate name, vote count) pairs
+     * @return VoteStatus::Ok if applied; otherwise nothing changed
+     * @throws std::runtime_error if the write-ahead log or tally file fails
+     * 
+     * Reports and snapshots never show part of a precinct's report.
+     */
+    VoteStatus processPrecinctReport(const std::string& districtName, const std::string& precinctId,
+                                     const std::vector<std::pair<std::string, int64_t>>& candidateVotes);
+    
+    /**
+     * @brief Start the applier thread for asynchronous ingestion
+     * @param queueCapacity Maximum number of updates waiting to be applied
+     * 
+     * Call after setupElection; districts and candidates are fixed from here on.
+     */
+    void startIngestion(size_t queueCapacity = 65536);
+    
+    /**
+     * @brief Queue a vote update for the applier thread
+     * @param districtName The district name
+     * @param candidateName The candidate name
+     * @param voteCount The number of votes
+     * @param precinctId The precinct identifier
+     * @return True if queued; false if the election is inactive, a name is
+     *         unknown, ingestion is not running, or the queue is full
+     * 
+     * Safe to call from any number of threads. Never blocks on tally work.
+     */
+    bool submitVoteUpdate(const std::string& districtName,
+                          const std::string& candidateName,
+                          int64_t voteCount,
+                          const std::string& precinctId);
+    
+    /**
+     * @brief Wait until every update submitted so far has been applied, rejected or dropped
+     */
+    void flushIngestion();
+    
+    /**
+     * @brief Apply anything still queued and stop the applier thread
+     * 
+     * Submissions racing with the stop are either refused or applied
+     * before this returns; none are left in the queue.
+     */
+    void stopIngestion();
+    
+    /**
+     * @brief Get queue depth, throughput and drain latency counters
+     */
+    IngestionStats getIngestionStats() const;
+    
+    /**
+     * @brief Get a consistent view of the current results
+     * @return An immutable snapshot that stays valid while ingestion continues
+     * 
+     * Reports are rendered from a snapshot, so they never mix totals from
+     * before and after an update and only block the applier while it is taken.
+     */
+    std::shared_ptr<const VoteSnapshot> getSnapshot() const;
+    
     /**
      * @brief Get current election results
      * @return Formatted string with current results
@@ -115,6 +308,8 @@ public:
     /**
      * @brief Get access to the VoteManager for detailed operations
      * @return Pointer to the VoteManager
+     * 
+     * Not synchronized with the applier thread; flush or stop ingestion first.
      */
     const VoteManager* getVoteManager() const { return voteManager.get(); }
 };
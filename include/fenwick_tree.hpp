@@ -1,68 +1,117 @@
 #pragma once
 #include <vector>
 #include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <stdexcept>
+#include <algorithm>
+#include <type_traits>
 
 /**
  * @brief Fenwick Tree (Binary Indexed Tree) implementation for efficient range sum queries
- * 
+ *
  * Provides O(log n) time complexity for:
  * - Point updates (adding/subtracting values)
  * - Range sum queries (prefix sums)
- * 
+ *
  * This is the core data structure that enables fast vote counting and aggregation.
+ *
+ * @tparam Counter The integer type stored in each node. Narrow unsigned
+ *         counters (e.g. uint32_t for precinct-level trees) halve memory;
+ *         negative deltas then wrap and still cancel out correctly.
+ *         std::atomic counters select the lock-free specialization in
+ *         concurrent_fenwick_tree.hpp.
+ * @tparam Index The unsigned type used for indices and the tree size
  */
-class FenwickTree {
+template <typename Counter, typename Index = size_t>
+class BasicFenwickTree {
+    static_assert(std::is_integral<Counter>::value, "Fenwick Tree counters must be integers");
+    static_assert(std::is_unsigned<Index>::value, "Fenwick Tree indices must be unsigned");
+
+public:
+    using value_type = Counter;
+    using index_type = Index;
+
 private:
-    std::vector<int64_t> tree;
-    size_t size;
+    std::vector<Counter> tree;
+    Index size;
 
     /**
      * @brief Get the least significant bit of a number
      * @param x The number
      * @return The least significant bit
      */
-    static int64_t lsb(int64_t x);
+    static Index lsb(Index x) { return static_cast<Index>(x & (~x + 1)); }
 
 public:
     /**
      * @brief Construct a Fenwick Tree with given size
      * @param n The size of the tree
      */
-    explicit FenwickTree(size_t n);
+    explicit BasicFenwickTree(Index n);
+
+    /**
+     * @brief Build a Fenwick Tree holding the given point values
+     * @param values values[i - 1] becomes the value at index i
+     * @return The new tree, of size values.size()
+     *
+     * Time complexity: O(n)
+     */
+    static BasicFenwickTree fromValues(const std::vector<Counter>& values);
 
     /**
      * @brief Update the value at index i by adding delta
      * @param i The index to update (1-based indexing)
      * @param delta The value to add
-     * 
+     *
      * Time complexity: O(log n)
      */
-    void update(size_t i, int64_t delta);
+    void update(Index i, Counter delta);
 
     /**
      * @brief Get the prefix sum from index 1 to i
      * @param i The end index (1-based indexing)
      * @return The sum of values from index 1 to i
-     * 
+     *
      * Time complexity: O(log n)
      */
-    int64_t query(size_t i) const;
+    Counter query(Index i) const;
+
+    /**
+     * @brief Apply a batch of (index, delta) updates
+     * @param deltas The updates to apply (1-based indices, repeats allowed)
+     *
+     * All indices are validated before anything is applied, so an invalid
+     * batch leaves the tree unchanged. Large batches are folded into a
+     * single linear pass instead of one walk per update.
+     *
+     * Time complexity: O(min(k log n, n + k))
+     */
+    void applyBatch(const std::vector<std::pair<Index, Counter>>& deltas);
+
+    /**
+     * @brief Apply one delta per index in a single linear pass
+     * @param deltas deltas[i - 1] is added at index i; may be shorter than the tree
+     *
+     * Time complexity: O(n)
+     */
+    void applyDenseBatch(const std::vector<Counter>& deltas);
 
     /**
      * @brief Get the sum of values in range [left, right]
      * @param left The left boundary (1-based indexing)
      * @param right The right boundary (1-based indexing)
      * @return The sum of values in the range
-     * 
+     *
      * Time complexity: O(log n)
      */
-    int64_t rangeQuery(size_t left, size_t right) const;
+    Counter rangeQuery(Index left, Index right) const;
 
     /**
      * @brief Get the current size of the tree
      * @return The size of the tree
      */
-    size_t getSize() const { return size; }
+    Index getSize() const { return size; }
 
     /**
      * @brief Reset all values in the tree to zero
@@ -74,5 +123,169 @@ public:
      * @param i The index (1-based indexing)
      * @return The value at index i
      */
-    int64_t getValue(size_t i) const;
+    Counter getValue(Index i) const;
+
+    /**
+     * @brief Extract all point values
+     * @return The values, with index i at position i - 1
+     *
+     * Time complexity: O(n)
+     */
+    std::vector<Counter> toValues() const;
 };
+
+/**
+ * @brief The default tree: 64-bit signed counters, size_t indices
+ */
+using FenwickTree = BasicFenwickTree<int64_t, size_t>;
+
+// ---------------------------------------------------------------------------
+// Implementation
+// ---------------------------------------------------------------------------
+
+template <typename Counter, typename Index>
+BasicFenwickTree<Counter, Index>::BasicFenwickTree(Index n) : size(n) {
+    if (n == 0) {
+        throw std::invalid_argument("Fenwick Tree size must be greater than 0");
+    }
+    // Initialize tree with size + 1 because Fenwick Trees use 1-based indexing
+    tree.resize(static_cast<size_t>(n) + 1, 0);
+}
+
+template <typename Counter, typename Index>
+BasicFenwickTree<Counter, Index> BasicFenwickTree<Counter, Index>::fromValues(const std::vector<Counter>& values) {
+    BasicFenwickTree result(static_cast<Index>(values.size()));
+    std::copy(values.begin(), values.end(), result.tree.begin() + 1);
+
+    // Push each node's finished sum up to its parent, in index order
+    for (size_t i = 1; i <= result.size; ++i) {
+        size_t parent = i + lsb(static_cast<Index>(i));
+        if (parent <= result.size) {
+            result.tree[parent] += result.tree[i];
+        }
+    }
+    return result;
+}
+
+template <typename Counter, typename Index>
+void BasicFenwickTree<Counter, Index>::update(Index i, Counter delta) {
+    if (i == 0 || i > size) {
+        throw std::out_of_range("Index out of range for Fenwick Tree update");
+    }
+
+    // Update all affected nodes in the tree (walk in size_t so a full-range
+    // Index type cannot wrap around)
+    for (size_t node = i; node <= size; node += lsb(static_cast<Index>(node))) {
+        tree[node] += delta;
+    }
+}
+
+template <typename Counter, typename Index>
+void BasicFenwickTree<Counter, Index>::applyBatch(const std::vector<std::pair<Index, Counter>>& deltas) {
+    for (const auto& entry : deltas) {
+        if (entry.first == 0 || entry.first > size) {
+            throw std::out_of_range("Index out of range for Fenwick Tree applyBatch");
+        }
+    }
+
+    // Separate walks cost k * log n; a dense merge costs n
+    size_t logSize = 1;
+    while ((size_t(1) << logSize) < size) {
+        ++logSize;
+    }
+    if (deltas.size() * logSize < size) {
+        for (const auto& entry : deltas) {
+            update(entry.first, entry.second);
+        }
+        return;
+    }
+
+    std::vector<Counter> dense(size, 0);
+    for (const auto& entry : deltas) {
+        dense[entry.first - 1] += entry.second;
+    }
+    applyDenseBatch(dense);
+}
+
+template <typename Counter, typename Index>
+void BasicFenwickTree<Counter, Index>::applyDenseBatch(const std::vector<Counter>& deltas) {
+    if (deltas.size() > size) {
+        throw std::out_of_range("Too many deltas for Fenwick Tree applyDenseBatch");
+    }
+
+    // Each node i covers its own delta plus everything its children pushed
+    // up to it; carry that subtotal to the parent so every node is touched once
+    std::vector<Counter> carry(deltas.begin(), deltas.end());
+    carry.resize(size, 0);
+    for (size_t i = 1; i <= size; ++i) {
+        tree[i] += carry[i - 1];
+        size_t parent = i + lsb(static_cast<Index>(i));
+        if (parent <= size) {
+            carry[parent - 1] += carry[i - 1];
+        }
+    }
+}
+
+// prefix sum: sum[1..i]=arr[1]+arr[2]+⋯+arr[i]
+
+template <typename Counter, typename Index>
+Counter BasicFenwickTree<Counter, Index>::query(Index i) const {
+    if (i == 0) return 0;
+    if (i > size) {
+        throw std::out_of_range("Index out of range for Fenwick Tree query");
+    }
+
+    Counter sum = 0;
+    // Sum all values from index 1 to i
+    while (i > 0) {
+        sum += tree[i];
+        i -= lsb(i);
+    }
+    return sum;
+}
+
+template <typename Counter, typename Index>
+Counter BasicFenwickTree<Counter, Index>::rangeQuery(Index left, Index right) const {
+    if (left > right) {
+        throw std::invalid_argument("Left boundary must be <= right boundary");
+    }
+    if (left == 0 || right > size) {
+        throw std::out_of_range("Range boundaries out of range for Fenwick Tree");
+    }
+
+    // Range sum = prefix[sum to right] - prefix[sum to (left-1)]
+    return static_cast<Counter>(query(right) - query(left - 1));
+}
+
+template <typename Counter, typename Index>
+void BasicFenwickTree<Counter, Index>::reset() {
+    std::fill(tree.begin(), tree.end(), 0);
+}
+
+template <typename Counter, typename Index>
+Counter BasicFenwickTree<Counter, Index>::getValue(Index i) const {
+    if (i == 0 || i > size) {
+        throw std::out_of_range("Index out of range for Fenwick Tree getValue");
+    }
+
+    // Get the value at index i by querying the range [i, i]
+    return rangeQuery(i, i);
+}
+
+template <typename Counter, typename Index>
+std::vector<Counter> BasicFenwickTree<Counter, Index>::toValues() const {
+    std::vector<Counter> values(tree.begin() + 1, tree.end());
+
+    // Undo fromValues in reverse order; a node's own sum is final by the
+    // time it is subtracted from its parent
+    for (size_t i = size; i >= 1; --i) {
+        size_t parent = i + lsb(static_cast<Index>(i));
+        if (parent <= size) {
+            values[parent - 1] -= values[i - 1];
+        }
+    }
+    return values;
+}
+
+// The default tree is instantiated once in fenwick_tree.cpp
+extern template class BasicFenwickTree<int64_t, size_t>;
@@ -0,0 +1,154 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+/**
+ * @brief Fenwick Tree with compile-time capacity and inline storage
+ *
+ * Same interface as FenwickTree, but nodes live in a std::array sized at
+ * compile time, so a tree costs no heap allocation and every walk is
+ * bounded by the constant N. Updates always walk up to N rather than the
+ * active size, which keeps the loop bound constant for the optimizer;
+ * nodes past the active size are never read by queries.
+ *
+ * Unlike FenwickTree, update/query/getValue do not bounds-check: callers
+ * must pass 1 <= i <= getSize(). Only the constructor validates its size.
+ *
+ * @tparam N The maximum number of elements
+ */
+template <size_t N>
+class FixedFenwickTree {
+    static_assert(N > 0, "FixedFenwickTree capacity must be greater than 0");
+
+private:
+    std::array<int64_t, N + 1> tree{};
+    size_t size;
+
+    static constexpr size_t lsb(size_t x) { return x & (~x + 1); }
+
+public:
+    /**
+     * @brief Get the compile-time capacity
+     */
+    static constexpr size_t capacity() { return N; }
+
+    /**
+     * @brief Construct a tree with the given active size
+     * @param n The number of elements in use, at most N
+     */
+    explicit constexpr FixedFenwickTree(size_t n = N) : size(n) {
+        if (n == 0 || n > N) {
+            throw std::invalid_argument("FixedFenwickTree size must be in [1, N]");
+        }
+    }
+
+    /**
+     * @brief Build a tree holding the given point values
+     * @param values values[i - 1] becomes the value at index i
+     *
+     * Time complexity: O(N)
+     */
+    static FixedFenwickTree fromValues(const std::vector<int64_t>& values) {
+        FixedFenwickTree result(values.size());
+        for (size_t i = 1; i <= values.size(); ++i) {
+            result.tree[i] = values[i - 1];
+        }
+        for (size_t i = 1; i <= N; ++i) {
+            size_t parent = i + lsb(i);
+            if (parent <= N) {
+                result.tree[parent] += result.tree[i];
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Update the value at index i by adding delta
+     * @param i The index to update (1-based indexing, unchecked)
+     * @param delta The value to add
+     */
+    constexpr void update(size_t i, int64_t delta) {
+        for (; i <= N; i += lsb(i)) {
+            tree[i] += delta;
+        }
+    }
+
+    /**
+     * @brief Get the prefix sum from index 1 to i
+     * @param i The end index (1-based indexing, unchecked; 0 gives 0)
+     */
+    constexpr int64_t query(size_t i) const {
+        int64_t sum = 0;
+        for (; i > 0; i -= lsb(i)) {
+            sum += tree[i];
+        }
+        return sum;
+    }
+
+    /**
+     * @brief Get the sum of values in range [left, right] (unchecked)
+     */
+    constexpr int64_t rangeQuery(size_t left, size_t right) const {
+        return query(right) - query(left - 1);
+    }
+
+    /**
+     * @brief Get the value at a specific index (unchecked)
+     */
+    constexpr int64_t getValue(size_t i) const {
+        return rangeQuery(i, i);
+    }
+
+    /**
+     * @brief Apply one delta per index in a single linear pass
+     * @param deltas deltas[i - 1] is added at index i; may be shorter than the tree
+     */
+    void applyDenseBatch(const std::vector<int64_t>& deltas) {
+        if (deltas.size() > size) {
+            throw std::out_of_range("Too many deltas for FixedFenwickTree applyDenseBatch");
+        }
+        std::array<int64_t, N + 1> carry{};
+        for (size_t i = 0; i < deltas.size(); ++i) {
+            carry[i + 1] = deltas[i];
+        }
+        for (size_t i = 1; i <= N; ++i) {
+            tree[i] += carry[i];
+            size_t parent = i + lsb(i);
+            if (parent <= N) {
+                carry[parent] += carry[i];
+            }
+        }
+    }
+
+    /**
+     * @brief Extract all point values
+     * @return The values, with index i at position i - 1
+     */
+    std::vector<int64_t> toValues() const {
+        std::array<int64_t, N + 1> values = tree;
+        for (size_t i = N; i >= 1; --i) {
+            size_t parent = i + lsb(i);
+            if (parent <= N) {
+                values[parent] -= values[i];
+            }
+        }
+        return std::vector<int64_t>(values.begin() + 1, values.begin() + 1 + size);
+    }
+
+    /**
+     * @brief Get the active size of the tree
+     */
+    constexpr size_t getSize() const { return size; }
+
+    /**
+     * @brief Reset all values in the tree to zero
+     */
+    constexpr void reset() {
+        for (auto& node : tree) {
+            node = 0;
+        }
+    }
+};
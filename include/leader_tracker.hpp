@@ -0,0 +1,105 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+
+/**
+ * @brief Tournament tree that keeps the index of the largest value current
+ *
+ * Each leaf holds one value; each internal node holds the index of the
+ * winning leaf below it, so the overall winner is always at the root.
+ * Ties go to the lower index. Leaves start out inactive and never win
+ * until they are activated.
+ *
+ * Provides:
+ * - O(1) leader queries
+ * - O(log n) value updates
+ */
+class LeaderTracker {
+private:
+    static constexpr int64_t kInactive = std::numeric_limits<int64_t>::min();
+
+    std::vector<int64_t> values;   // Leaf values, padded to a power of two
+    std::vector<uint32_t> winners; // winners[1] is the root, leaves start at capacity
+    size_t count = 0;
+    size_t capacity = 0;
+
+    uint32_t play(uint32_t left, uint32_t right) const {
+        return values[right] > values[left] ? right : left;
+    }
+
+    /**
+     * @brief Replay the matches on the path from leaf i to the root
+     */
+    void replay(size_t i);
+
+    /**
+     * @brief Rebuild the whole tree for a new capacity
+     */
+    void rebuild(size_t newCapacity);
+
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    /**
+     * @brief Construct a tracker with n inactive leaves
+     * @param n The number of leaves
+     */
+    explicit LeaderTracker(size_t n = 0);
+
+    /**
+     * @brief Append a new active leaf
+     * @param value The initial value of the leaf
+     *
+     * Amortized time complexity: O(log n)
+     */
+    void append(int64_t value = 0);
+
+    /**
+     * @brief Make a leaf eligible to win, with a value of zero
+     * @param i The leaf index (0-based)
+     */
+    void activate(size_t i);
+
+    /**
+     * @brief Add delta to an active leaf
+     * @param i The leaf index (0-based)
+     * @param delta The value to add
+     *
+     * Time complexity: O(log n)
+     */
+    void add(size_t i, int64_t delta);
+
+    /**
+     * @brief Get the value of a leaf
+     * @param i The leaf index (0-based)
+     * @return The leaf value (0 for inactive leaves)
+     */
+    int64_t value(size_t i) const {
+        return values[i] == kInactive ? 0 : values[i];
+    }
+
+    /**
+     * @brief Get the index of the leaf with the largest value
+     * @return The leader index, or npos if no leaf is active
+     *
+     * Time complexity: O(1)
+     */
+    size_t leader() const {
+        if (count == 0 || values[winners[1]] == kInactive) {
+            return npos;
+        }
+        return winners[1];
+    }
+
+    /**
+     * @brief Get the number of leaves
+     */
+    size_t size() const { return count; }
+
+    /**
+     * @brief Reset every active leaf to zero
+     */
+    void reset();
+};
@@ -0,0 +1,148 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "tally_store.hpp"
+#include "binary_file.hpp"
+
+/**
+ * @brief When MappedTallyStore writes dirty pages back to disk
+ *
+ * Every policy survives the process being killed, since the mapping is in
+ * the page cache. The policies differ in what survives a power loss.
+ */
+enum class MsyncPolicy {
+    None,         ///< Leave write-back to the OS; call sync() explicitly
+    Interval,     ///< Sync the whole file every syncInterval commits
+    EveryCommit   ///< Sync the journal before and the row after every change
+};
+
+/**
+ * @brief Settings for MappedTallyStore
+ */
+struct MappedTallyOptions {
+    MsyncPolicy syncPolicy = MsyncPolicy::None;
+    uint64_t syncInterval = 1024;  // Commits between syncs under MsyncPolicy::Interval
+};
+
+/**
+ * @brief Tally store whose Fenwick rows live in a memory-mapped file
+ *
+ * The file holds a fixed header followed by one record per district,
+ * [slot count][Fenwick nodes], native-endian 64-bit words. Reopening the
+ * file and adding the same districts again reattaches their rows as they
+ * are: queries work at once, with nothing parsed or rebuilt. Adding more
+ * districts than the file holds appends new, zeroed rows.
+ *
+ * Every change is crash-consistent. Before a row is modified, the old
+ * value of each node it touches is written to an undo journal behind the
+ * last record and the header is marked. If the process dies mid-change,
+ * the next open rolls the row back, so the file always holds whole
+ * commits. getCommitCount() says how many.
+ */
+class MappedTallyStore : public TallyStore {
+public:
+    /**
+     * @brief Open or create a tally file
+     * @param path The file to map
+     * @param options When to write dirty pages back to disk
+     * @throws std::runtime_error if the file is not a tally file or cannot be mapped
+     */
+    explicit MappedTallyStore(const std::string& path, MappedTallyOptions options = MappedTallyOptions());
+
+    /**
+     * @brief Reattach the next stored district, or append a new one
+     * @throws std::runtime_error if a stored district has a different size
+     */
+    void addDistrict(size_t candidateCount) override;
+    void update(size_t district, size_t slot, int64_t delta) override;
+    void applyDenseBatch(size_t district, const std::vector<int64_t>& slotDeltas) override;
+    int64_t getValue(size_t district, size_t slot) const override;
+    int64_t getDistrictTotal(size_t district) const override;
+    void readDistrict(size_t district, std::vector<int64_t>& out) const override;
+    void loadDistrict(size_t district, const std::vector<int64_t>& values) override;
+    size_t getSlotCount(size_t district) const override;
+    void reset() override;
+
+    /**
+     * @brief Get the number of changes committed to the file, across restarts
+     */
+    uint64_t getCommitCount() const { return header()->commitCount; }
+
+    /**
+     * @brief Get the number of districts stored in the file
+     */
+    size_t getStoredDistrictCount() const { return rowOffsets.size(); }
+
+    /**
+     * @brief Write every dirty page back to disk
+     * @throws std::runtime_error if the sync fails
+     */
+    void sync();
+
+private:
+    enum class JournalState : uint64_t { Idle = 0, Undo = 1, Reset = 2 };
+
+    // The first 64 bytes of the file
+    struct Header {
+        uint64_t magic;
+        uint64_t format;
+        uint64_t districtCount;   // Records that are complete
+        uint64_t commitCount;
+        uint64_t journalState;
+        uint64_t journalEntries;  // Valid undo entries while journalState is Undo
+        uint64_t journalBase;     // commitCount before the change in flight
+        uint64_t reserved;
+    };
+
+    // Undo entries are (word offset, old value) pairs after the last record
+    struct JournalEntry {
+        uint64_t word;
+        int64_t oldValue;
+    };
+
+    std::string path;
+    MappedTallyOptions options;
+    MappedFile file;
+
+    std::vector<uint64_t> rowOffsets;  // Word offset of each district's first node
+    std::vector<size_t> slotCounts;
+    size_t attachedCount = 0;          // Districts claimed by addDistrict so far
+    uint64_t recordsEnd;               // Word offset just past the last record (journal start)
+    size_t widestRow = 0;
+
+    Header* header() const { return reinterpret_cast<Header*>(file.data()); }
+    int64_t* words() const { return reinterpret_cast<int64_t*>(file.data()); }
+    JournalEntry* journal() const { return reinterpret_cast<JournalEntry*>(words() + recordsEnd); }
+
+    int64_t prefix(size_t district, size_t slot) const;
+
+    /**
+     * @brief Grow the file so the records plus a full-width journal fit
+     */
+    void reserveWords(uint64_t recordWords, size_t journalCapacity);
+
+    /**
+     * @brief Publish the journal entries written so far and mark the change in flight
+     */
+    void beginChange(size_t entryCount);
+
+    /**
+     * @brief Count the commit, clear the journal and apply the sync policy
+     * @param firstWord Start of the words that changed, for EveryCommit
+     * @param wordCount Number of words that changed
+     */
+    void commitChange(uint64_t firstWord, uint64_t wordCount);
+
+    /**
+     * @brief Write a byte range back to disk
+     * @throws std::runtime_error if the sync fails
+     */
+    void syncRange(size_t offset, size_t length);
+
+    /**
+     * @brief Roll back or finish a change interrupted by a crash
+     */
+    void recover();
+};
@@ -0,0 +1,107 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+/**
+ * @brief Bounded lock-free multi-producer, single-consumer queue
+ *
+ * A ring of cells, each with a sequence number that tells producers and
+ * the consumer whose turn it is (Vyukov's bounded queue). Producers claim
+ * a cell with one CAS on the enqueue position and never wait: tryPush()
+ * fails immediately if the ring is full. The single consumer needs no
+ * atomic read-modify-write at all.
+ *
+ * Any number of threads may call tryPush() concurrently; only one thread
+ * at a time may call tryPop().
+ */
+template <typename T>
+class MpscQueue {
+public:
+    /**
+     * @brief Construct an empty queue
+     * @param capacity Minimum number of elements; rounded up to a power of two
+     */
+    explicit MpscQueue(size_t capacity) {
+        size_t rounded = 2;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        mask = rounded - 1;
+        cells.reset(new Cell[rounded]);
+        for (size_t i = 0; i < rounded; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Push an element; safe from any thread
+     * @return False if the queue is full (the element is left untouched)
+     */
+    bool tryPush(T&& value) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells[pos & mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Pop the oldest element; consumer thread only
+     * @return False if the queue is empty
+     */
+    bool tryPop(T& out) {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Cell& cell = cells[pos & mask];
+        if (cell.sequence.load(std::memory_order_acquire) != pos + 1) {
+            return false;
+        }
+        out = std::move(cell.value);
+        cell.sequence.store(pos + mask + 1, std::memory_order_release);
+        dequeuePos.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Approximate number of queued elements (exact when quiescent)
+     */
+    size_t sizeApprox() const {
+        size_t tail = dequeuePos.load(std::memory_order_acquire);
+        size_t head = enqueuePos.load(std::memory_order_acquire);
+        return head > tail ? head - tail : 0;
+    }
+
+    /**
+     * @brief Get the number of elements the queue can hold
+     */
+    size_t capacity() const { return mask + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+
+    // Producer and consumer positions on separate cache lines
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) std::atomic<size_t> dequeuePos{0};
+};
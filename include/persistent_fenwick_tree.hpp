@@ -0,0 +1,112 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+/**
+ * @brief Fenwick Tree that keeps every past version queryable
+ *
+ * Fat-node persistence: each node stores the list of (version, value)
+ * pairs it has taken, in increasing version order. An update appends to
+ * the O(log n) nodes on its walk, or adds in place when the node already
+ * has an entry for that version. A query at version v binary-searches each
+ * node on its walk for the last entry at or before v.
+ *
+ * Time complexity: update O(log n), query at a version O(log n * log V),
+ * where V is the number of versions a node has seen.
+ *
+ * Memory grows with every update; compact() folds everything before a
+ * checkpoint into a single base entry per node.
+ */
+class PersistentFenwickTree {
+private:
+    using Entry = std::pair<uint64_t, int64_t>;
+
+    std::vector<std::vector<Entry>> nodes;
+    size_t size;
+    uint64_t latestVersion = 0;
+    uint64_t oldestVersion = 0;
+
+    static size_t lsb(size_t x) { return x & (~x + 1); }
+
+    /**
+     * @brief Get a node's value as of a version (0 before its first entry)
+     */
+    int64_t nodeAt(size_t node, uint64_t version) const;
+
+    /**
+     * @brief Set a node's value at a version, appending or overwriting the last entry
+     */
+    void record(size_t node, uint64_t version, int64_t value);
+
+public:
+    /**
+     * @brief Construct a tree of size n, all zero as of version 0
+     * @param n The size of the tree
+     */
+    explicit PersistentFenwickTree(size_t n);
+
+    /**
+     * @brief Add delta to the value at index i as of a version
+     * @param i The index to update (1-based indexing)
+     * @param delta The value to add
+     * @param version The version of this update; must not be older than the latest
+     *
+     * Time complexity: O(log n)
+     */
+    void update(size_t i, int64_t delta, uint64_t version);
+
+    /**
+     * @brief Get the prefix sum from index 1 to i as of a version
+     * @param i The end index (1-based indexing)
+     * @param version Any version from getOldestVersion() on
+     *
+     * Time complexity: O(log n * log V)
+     */
+    int64_t queryAt(size_t i, uint64_t version) const;
+
+    /**
+     * @brief Get the sum of values in range [left, right] as of a version
+     */
+    int64_t rangeQueryAt(size_t left, size_t right, uint64_t version) const;
+
+    /**
+     * @brief Get the value at index i as of a version
+     */
+    int64_t getValueAt(size_t i, uint64_t version) const;
+
+    /**
+     * @brief Zero every value as of a version, keeping earlier versions queryable
+     */
+    void reset(uint64_t version);
+
+    /**
+     * @brief Forget versions older than a checkpoint
+     * @param checkpoint The oldest version that must stay queryable
+     *
+     * Every node keeps one entry for its value at the checkpoint plus its
+     * later entries. Time complexity: O(total entries)
+     */
+    void compact(uint64_t checkpoint);
+
+    /**
+     * @brief Get the newest version written
+     */
+    uint64_t getLatestVersion() const { return latestVersion; }
+
+    /**
+     * @brief Get the oldest version still queryable
+     */
+    uint64_t getOldestVersion() const { return oldestVersion; }
+
+    /**
+     * @brief Get the number of stored (version, value) entries across all nodes
+     */
+    size_t getEntryCount() const;
+
+    /**
+     * @brief Get the size of the tree
+     */
+    size_t getSize() const { return size; }
+};
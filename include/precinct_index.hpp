@@ -0,0 +1,134 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+
+/**
+ * @brief Dense handle of a precinct within a PrecinctIndex
+ */
+using PrecinctHandle = uint32_t;
+
+/**
+ * @brief Per-precinct vote counters and reporting state
+ *
+ * A precinct is a (district, precinct id) pair, where the id is one
+ * interned by VoteHistory. Handles are given out in insertion order and
+ * index straight into the precinct table, so every query is O(1):
+ * - a counter row per precinct, one counter per district slot, plus a total
+ * - per district, the list of its precincts and a bitmap of those that
+ *   have reported, with a running count of set bits
+ *
+ * Looking a precinct up by id is one array access when the id is only
+ * used in one district (the usual case); ids reused across districts fall
+ * back to a hash lookup.
+ */
+class PrecinctIndex {
+public:
+    static constexpr PrecinctHandle npos = std::numeric_limits<PrecinctHandle>::max();
+
+    /**
+     * @brief Start tracking a new district
+     * @param slotCount The number of counters in each of its precincts' rows
+     */
+    void addDistrict(size_t slotCount);
+
+    /**
+     * @brief Get a precinct's handle, adding it unreported on first use
+     * @param district The district handle
+     * @param precinctId An id from VoteHistory::internPrecinct()
+     */
+    PrecinctHandle addPrecinct(uint32_t district, uint32_t precinctId);
+
+    /**
+     * @brief Look up a precinct without adding it
+     * @return The handle, or npos if the district has no such precinct
+     */
+    PrecinctHandle find(uint32_t district, uint32_t precinctId) const;
+
+    /**
+     * @brief Count votes for a precinct and mark it as reported
+     * @param precinct The precinct handle
+     * @param slot The 1-based slot of the candidate within the district
+     * @param delta The votes added
+     */
+    void add(PrecinctHandle precinct, size_t slot, int64_t delta) {
+        Entry& entry = entries[precinct];
+        counters[entry.offset + slot - 1] += delta;
+        entry.total += delta;
+        uint64_t& word = districts[entry.district].reportedBits[entry.local / 64];
+        uint64_t bit = uint64_t(1) << (entry.local % 64);
+        if (!(word & bit)) {
+            word |= bit;
+            ++districts[entry.district].reportedCount;
+        }
+    }
+
+    /**
+     * @brief Zero every counter and clear every reported flag; precincts stay known
+     */
+    void reset();
+
+    size_t size() const { return entries.size(); }
+
+    uint32_t getDistrict(PrecinctHandle precinct) const { return entries[precinct].district; }
+    uint32_t getPrecinctId(PrecinctHandle precinct) const { return entries[precinct].precinctId; }
+    bool isReported(PrecinctHandle precinct) const {
+        const Entry& entry = entries[precinct];
+        return (districts[entry.district].reportedBits[entry.local / 64] >> (entry.local % 64)) & 1;
+    }
+    int64_t getTotal(PrecinctHandle precinct) const { return entries[precinct].total; }
+
+    /**
+     * @brief Get a precinct's votes for the candidate in a 1-based slot
+     */
+    int64_t getVotes(PrecinctHandle precinct, size_t slot) const {
+        return counters[entries[precinct].offset + slot - 1];
+    }
+
+    /**
+     * @brief Get the precincts of a district, in the order they were added
+     */
+    const std::vector<PrecinctHandle>& getPrecincts(uint32_t district) const { return districts[district].precincts; }
+
+    /**
+     * @brief Get the number of precincts known in a district
+     */
+    size_t getPrecinctCount(uint32_t district) const { return districts[district].precincts.size(); }
+
+    /**
+     * @brief Get a district's reported flags, bit i for the i-th precinct of getPrecincts()
+     */
+    const std::vector<uint64_t>& getReportedBits(uint32_t district) const { return districts[district].reportedBits; }
+
+    /**
+     * @brief Get the number of a district's precincts that have reported
+     */
+    size_t getReportedCount(uint32_t district) const { return districts[district].reportedCount; }
+
+private:
+    struct Entry {
+        uint32_t district;
+        uint32_t precinctId;
+        uint32_t local;      // Position within the district's precinct list and bitmap
+        size_t offset;       // Start of the counter row
+        int64_t total;
+    };
+
+    struct DistrictState {
+        size_t slotCount;
+        std::vector<PrecinctHandle> precincts;
+        std::vector<uint64_t> reportedBits;
+        size_t reportedCount = 0;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<int64_t> counters;  // Counter rows of every precinct, back to back
+    std::vector<DistrictState> districts;
+
+    // Precinct id -> handle in the first district that used it, and
+    // (district << 32 | id) -> handle for any other district
+    std::vector<PrecinctHandle> firstById;
+    std::unordered_map<uint64_t, PrecinctHandle> otherDistricts;
+};
@@ -0,0 +1,105 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief District x candidate tally split into per-thread shards
+ *
+ * Each ingestion thread owns one shard: a private, cache-line padded copy
+ * of the whole tally in which it is the only writer. Writes therefore
+ * never contend with other threads, not even on a hot district, and need
+ * no atomic read-modify-write. Reads sum the value across all shards.
+ *
+ * Every shard also carries a version counter in its own cache line; the
+ * sum of versions is an epoch that changes whenever any shard is written,
+ * which lets readers cache merged results until new votes arrive.
+ *
+ * Thread safety: add() may be called concurrently as long as each shard
+ * index is used by one thread at a time. Reads may run concurrently with
+ * writers and see each counter atomically. reset() requires quiescence.
+ */
+class ShardedTally {
+public:
+    /**
+     * @brief Construct zeroed shards for the given districts
+     * @param slotCounts Number of candidate slots in each district
+     * @param shardCount Number of shards (one per ingestion thread)
+     */
+    ShardedTally(const std::vector<size_t>& slotCounts, size_t shardCount);
+
+    /**
+     * @brief Add delta to a candidate slot of a district in one shard
+     * @param shard The writer's shard index
+     * @param district The district position
+     * @param slot The candidate slot (1-based indexing)
+     * @param delta The value to add
+     *
+     * Time complexity: O(1)
+     */
+    void add(size_t shard, size_t district, size_t slot, int64_t delta);
+
+    /**
+     * @brief Get a slot's value summed across shards
+     *
+     * Time complexity: O(shards)
+     */
+    int64_t getValue(size_t district, size_t slot) const;
+
+    /**
+     * @brief Add every slot value of a district, summed across shards, to out
+     * @param district The district position
+     * @param out Must hold at least the district's slot count; slot i is added at out[i - 1]
+     */
+    void accumulateDistrict(size_t district, std::vector<int64_t>& out) const;
+
+    /**
+     * @brief Get the current write epoch (changes whenever any shard is written)
+     */
+    uint64_t epoch() const;
+
+    /**
+     * @brief Get the number of shards
+     */
+    size_t getShardCount() const { return shardCount; }
+
+    /**
+     * @brief Get the number of candidate slots in a district
+     */
+    size_t getSlotCount(size_t district) const { return slotCounts[district]; }
+
+    /**
+     * @brief Reset every shard to zero (writers must be quiescent)
+     */
+    void reset();
+
+private:
+    static constexpr size_t kLineWords = 8;
+
+    // One cache line of counters
+    struct alignas(64) Line {
+        std::atomic<int64_t> words[kLineWords];
+    };
+
+    // Counter pointer in one cache line and the version in the next, so
+    // version bumps never invalidate the line readers load lines from
+    struct alignas(64) Shard {
+        std::unique_ptr<Line[]> lines;
+        alignas(64) std::atomic<uint64_t> version{0};
+    };
+
+    std::vector<size_t> slotCounts;
+    std::vector<size_t> rowOffsets;  // First counter of each district
+    size_t lineCount = 0;
+    size_t shardCount;
+    std::unique_ptr<Shard[]> shards;
+
+    std::atomic<int64_t>& counter(Shard& shard, size_t index) {
+        return shard.lines[index / kLineWords].words[index % kLineWords];
+    }
+    const std::atomic<int64_t>& counter(const Shard& shard, size_t index) const {
+        return shard.lines[index / kLineWords].words[index % kLineWords];
+    }
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Vectorized kernels over plain counter arrays
+ *
+ * Used by the direct-array representation for small races. Each kernel
+ * has an AVX2 path, an SSE path and a scalar fallback, picked at compile
+ * time from the target flags (configure with -DVOTE_COUNTER_NATIVE=ON to
+ * build for the host CPU). The sum needs SSE2 and the argmax SSE4.2, so a
+ * default x86-64 build vectorizes the sum but runs the argmax scalar.
+ */
+
+/**
+ * @brief Sum n counters
+ * @param values The counters
+ * @param n The number of counters
+ * @return The sum, 0 if n is 0
+ */
+int64_t sumCounters(const int64_t* values, size_t n);
+
+/**
+ * @brief Find the position of the largest counter
+ * @param values The counters
+ * @param n The number of counters, at least 1
+ * @return The index of the first counter holding the maximum value
+ */
+size_t argmaxCounters(const int64_t* values, size_t n);
+
+/**
+ * @brief Name of the instruction set sumCounters was compiled for
+ * @return "AVX2", "SSE2" or "scalar"
+ */
+const char* counterSumIsa();
+
+/**
+ * @brief Name of the instruction set argmaxCounters was compiled for
+ * @return "AVX2", "SSE4.2" or "scalar"
+ */
+const char* counterArgmaxIsa();
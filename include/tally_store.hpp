@@ -0,0 +1,314 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include "fenwick_tree.hpp"
+#include "fixed_fenwick_tree.hpp"
+
+/**
+ * @brief Largest district the FixedDistrictTrees backend accepts
+ */
+constexpr size_t kFixedFenwickCapacity = 32;
+
+/**
+ * @brief Largest district the Adaptive backend keeps as a plain counter array
+ */
+constexpr size_t kDirectTallyThreshold = 16;
+
+/**
+ * @brief Storage backends for the district x candidate tally
+ */
+enum class TallyStorage {
+    Adaptive,             ///< Plain counter arrays for small districts, FenwickTree above kDirectTallyThreshold
+    DistrictTrees,        ///< One heap-allocated FenwickTree per district
+    FixedDistrictTrees,   ///< One inline FixedFenwickTree per district (<= kFixedFenwickCapacity candidates)
+    DistrictMajorMatrix,  ///< One flat array, each district's tree in its own row
+    CandidateMajorMatrix, ///< One flat array, each candidate slot in its own row
+    Mapped                ///< Fenwick rows in a memory-mapped file (MappedTallyStore, needs a path)
+};
+
+/**
+ * @brief Interface for the storage behind VoteManager's vote tallies
+ *
+ * A store holds one Fenwick tree per district, addressed by the district's
+ * position (0-based, in insertion order) and a candidate slot (1-based, as
+ * in FenwickTree). Implementations differ only in memory layout.
+ */
+class TallyStore {
+public:
+    virtual ~TallyStore() = default;
+
+    /**
+     * @brief Append a district with room for the given number of candidates
+     * @param candidateCount The number of candidate slots in the district
+     */
+    virtual void addDistrict(size_t candidateCount) = 0;
+
+    /**
+     * @brief Add delta to a candidate slot in a district
+     * @param district The district position
+     * @param slot The candidate slot (1-based indexing)
+     * @param delta The value to add
+     *
+     * Time complexity: O(log n)
+     */
+    virtual void update(size_t district, size_t slot, int64_t delta) = 0;
+
+    /**
+     * @brief Add one delta per candidate slot of a district in a single pass
+     * @param district The district position
+     * @param slotDeltas slotDeltas[i - 1] is added to slot i; may be shorter than the district
+     *
+     * Time complexity: O(n)
+     */
+    virtual void applyDenseBatch(size_t district, const std::vector<int64_t>& slotDeltas) = 0;
+
+    /**
+     * @brief Get the value of a candidate slot in a district
+     * @param district The district position
+     * @param slot The candidate slot (1-based indexing)
+     * @return The value at the slot
+     */
+    virtual int64_t getValue(size_t district, size_t slot) const = 0;
+
+    /**
+     * @brief Get the sum of all slots in a district
+     * @param district The district position
+     * @return The district total
+     */
+    virtual int64_t getDistrictTotal(size_t district) const = 0;
+
+    /**
+     * @brief Read every slot value of a district in one pass
+     * @param district The district position
+     * @param out Receives the values of slots 1..n at out[0..n-1]
+     *
+     * Time complexity: O(n)
+     */
+    virtual void readDistrict(size_t district, std::vector<int64_t>& out) const = 0;
+
+    /**
+     * @brief Replace every slot value of a district in one pass
+     * @param district The district position
+     * @param values values[i - 1] becomes the value of slot i; must match the slot count
+     *
+     * Time complexity: O(n)
+     */
+    virtual void loadDistrict(size_t district, const std::vector<int64_t>& values) = 0;
+
+    /**
+     * @brief Get the number of candidate slots in a district
+     * @param district The district position
+     */
+    virtual size_t getSlotCount(size_t district) const = 0;
+
+    /**
+     * @brief Whether a district is stored as a plain counter array
+     * @param district The district position
+     *
+     * Direct districts answer getValue with one load and leadingSlot with a
+     * vector scan, so callers need not maintain their own leader index.
+     */
+    virtual bool isDirect(size_t district) const {
+        (void)district;
+        return false;
+    }
+
+    /**
+     * @brief Get the slot with the most votes among slots 1..slotCount
+     * @param district The district position
+     * @param slotCount How many leading slots to consider, at least 1
+     * @return The winning slot (1-based); ties go to the lower slot
+     *
+     * Time complexity: O(n)
+     */
+    virtual size_t leadingSlot(size_t district, size_t slotCount) const;
+
+    /**
+     * @brief Reset all values to zero
+     */
+    virtual void reset() = 0;
+};
+
+/**
+ * @brief Tally store keeping a separate tree per district
+ *
+ * @tparam Tree The per-district tree type, FenwickTree or a
+ *         FixedFenwickTree. Slots are range-checked here, so unchecked
+ *         fixed-capacity trees can be used safely.
+ */
+template <typename Tree>
+class TreeTallyStore : public TallyStore {
+private:
+    std::vector<Tree> trees;
+
+    void checkSlot(size_t district, size_t slot) const {
+        if (slot == 0 || slot > trees[district].getSize()) {
+            throw std::out_of_range("Index out of range for district tree");
+        }
+    }
+
+public:
+    void addDistrict(size_t candidateCount) override {
+        trees.emplace_back(candidateCount);
+    }
+
+    void update(size_t district, size_t slot, int64_t delta) override {
+        checkSlot(district, slot);
+        trees[district].update(slot, delta);
+    }
+
+    void applyDenseBatch(size_t district, const std::vector<int64_t>& slotDeltas) override {
+        trees[district].applyDenseBatch(slotDeltas);
+    }
+
+    int64_t getValue(size_t district, size_t slot) const override {
+        checkSlot(district, slot);
+        return trees[district].getValue(slot);
+    }
+
+    int64_t getDistrictTotal(size_t district) const override {
+        return trees[district].query(trees[district].getSize());
+    }
+
+    void readDistrict(size_t district, std::vector<int64_t>& out) const override {
+        out = trees[district].toValues();
+    }
+
+    void loadDistrict(size_t district, const std::vector<int64_t>& values) override {
+        if (values.size() != trees[district].getSize()) {
+            throw std::invalid_argument("Value count does not match district size");
+        }
+        trees[district] = Tree::fromValues(values);
+    }
+
+    size_t getSlotCount(size_t district) const override {
+        return trees[district].getSize();
+    }
+
+    void reset() override {
+        for (auto& tree : trees) {
+            tree.reset();
+        }
+    }
+};
+
+/**
+ * @brief Tally store with one FenwickTree per district
+ */
+using FenwickTallyStore = TreeTallyStore<FenwickTree>;
+
+/**
+ * @brief Tally store with one inline fixed-capacity tree per district
+ *
+ * Trees are stored by value in one vector, so small races need no
+ * per-district allocation at all.
+ */
+using FixedFenwickTallyStore = TreeTallyStore<FixedFenwickTree<kFixedFenwickCapacity>>;
+
+/**
+ * @brief Tally store keeping every district's Fenwick tree in one flat array
+ *
+ * Nodes live in a single 64-byte aligned buffer. With DistrictMajor layout
+ * each district owns a cache-line aligned row, so a district's update and
+ * full-row reads touch contiguous memory. With CandidateMajor layout node i
+ * of every district sits in row i, so scanning one candidate slot across
+ * all districts is a linear walk.
+ */
+class MatrixTallyStore : public TallyStore {
+public:
+    enum class Layout { DistrictMajor, CandidateMajor };
+
+    /**
+     * @brief Construct an empty matrix store
+     * @param layout Which dimension is contiguous in memory
+     */
+    explicit MatrixTallyStore(Layout layout);
+
+    void addDistrict(size_t candidateCount) override;
+    void update(size_t district, size_t slot, int64_t delta) override;
+    void applyDenseBatch(size_t district, const std::vector<int64_t>& slotDeltas) override;
+    int64_t getValue(size_t district, size_t slot) const override;
+    int64_t getDistrictTotal(size_t district) const override;
+    void readDistrict(size_t district, std::vector<int64_t>& out) const override;
+    void loadDistrict(size_t district, const std::vector<int64_t>& values) override;
+    size_t getSlotCount(size_t district) const override;
+    void reset() override;
+
+    /**
+     * @brief Get the memory layout of this store
+     */
+    Layout getLayout() const { return layout; }
+
+private:
+    static constexpr size_t kLineWords = 8;
+
+    // One cache line worth of tree nodes
+    struct alignas(64) Line {
+        int64_t words[kLineWords];
+    };
+
+    Layout layout;
+    std::vector<Line> lines;
+    std::vector<size_t> slotCounts;  // Fenwick size of each district
+    size_t width = 0;                // Largest slot count of any district
+    size_t districtCapacity = 0;     // Districts the buffer has room for
+
+    size_t offset(size_t district, size_t slot) const;
+    int64_t& node(size_t district, size_t slot);
+    int64_t node(size_t district, size_t slot) const;
+    int64_t prefix(size_t district, size_t slot) const;
+    void relayout(size_t newCapacity, size_t newWidth);
+};
+
+/**
+ * @brief Tally store that picks a representation per district
+ *
+ * Districts with at most the threshold number of candidates are kept as a
+ * plain counter array, packed back to back in one buffer: a point read is
+ * one load, and totals and leaders use the vectorized kernels from
+ * tally_kernels.hpp. Larger districts get a FenwickTree as usual.
+ */
+class AdaptiveTallyStore : public TallyStore {
+public:
+    /**
+     * @brief Construct an empty adaptive store
+     * @param directThreshold Largest district kept as a plain counter array
+     */
+    explicit AdaptiveTallyStore(size_t directThreshold = kDirectTallyThreshold);
+
+    void addDistrict(size_t candidateCount) override;
+    void update(size_t district, size_t slot, int64_t delta) override;
+    void applyDenseBatch(size_t district, const std::vector<int64_t>& slotDeltas) override;
+    int64_t getValue(size_t district, size_t slot) const override;
+    int64_t getDistrictTotal(size_t district) const override;
+    void readDistrict(size_t district, std::vector<int64_t>& out) const override;
+    void loadDistrict(size_t district, const std::vector<int64_t>& values) override;
+    size_t getSlotCount(size_t district) const override;
+    bool isDirect(size_t district) const override { return entries[district].direct; }
+    size_t leadingSlot(size_t district, size_t slotCount) const override;
+    void reset() override;
+
+private:
+    struct Entry {
+        bool direct;
+        size_t index;  // Offset into counters, or position in trees
+        size_t slots;
+    };
+
+    size_t directThreshold;
+    std::vector<Entry> entries;
+    std::vector<int64_t> counters;  // Direct districts, back to back
+    std::vector<FenwickTree> trees; // Districts above the threshold
+
+    void checkSlot(size_t district, size_t slot) const;
+};
+
+/**
+ * @brief Create a tally store for the given storage backend
+ * @param storage The backend to create
+ * @return The new, empty store
+ */
+std::unique_ptr<TallyStore> makeTallyStore(TallyStorage storage);
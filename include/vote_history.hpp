@@ -0,0 +1,253 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <cstdint>
+#include <cstddef>
+#include "chunked_array.hpp"
+
+/**
+ * @brief Append-only audit log of vote updates, stored column by column
+ *
+ * Each update takes 28 bytes across five arrays: district handle,
+ * candidate handle, interned precinct id, timestamp and delta. Columns are
+ * ChunkedArrays, so appending never moves existing rows: the worst-case
+ * append allocates one chunk instead of copying the whole history.
+ *
+ * Rows are appended in two steps, reserveRows() then publishRows(), so
+ * several threads can append concurrently without a lock, and readers can
+ * scan rows below size() while appends continue. Interning precincts and
+ * timestamp labels, clear() and copying are single-threaded.
+ *
+ * Published rows and interned strings never change until clear(), so
+ * sharePrefix() can hand them to another thread without copying. The
+ * chunks are reference counted, and clear() starts fresh chunks when the
+ * old ones are shared.
+ *
+ * Timestamps are nanoseconds since the Unix epoch, negative before 1970.
+ * Text timestamps are converted by encodeTimestamp(): ctime-style text
+ * ("Tue Nov  5 21:30:00 2024", local time) becomes nanoseconds, and any
+ * other label is interned and stored as a code from a band reserved at the
+ * bottom of the int64 range (before the year 1677), so it still reads back
+ * verbatim.
+ */
+class VoteHistory {
+private:
+    struct Columns {
+        ChunkedArray<uint32_t> district;
+        ChunkedArray<uint32_t> candidate;
+        ChunkedArray<uint32_t> precinct;
+        ChunkedArray<int64_t> timestamp;
+        ChunkedArray<int64_t> delta;
+    };
+
+    // Interned strings by id; ids below the counts are never rewritten
+    struct StringTables {
+        ChunkedArray<std::string, 8> precinctIds;
+        ChunkedArray<std::string, 8> timestampLabels;
+    };
+
+    std::shared_ptr<Columns> columns;
+    std::shared_ptr<StringTables> strings;
+    mutable bool columnsShared = false;  // Set by sharePrefix(), cleared when clear() replaces the columns
+
+    // Label codes are kLabelBase + label id
+    static constexpr int64_t kLabelBase = INT64_MIN;
+    static constexpr int64_t kLabelLimit = INT64_MIN + (int64_t(1) << 32);
+
+    // Rows handed out by reserveRows, and the prefix of them that is complete
+    std::atomic<size_t> reservedRows{0};
+    std::atomic<size_t> publishedRows{0};
+
+    // Interned precinct ids and free-form timestamp labels
+    size_t precinctIdCount = 0;
+    size_t timestampLabelCount = 0;
+    std::unordered_map<std::string, uint32_t> precinctLookup;
+    std::unordered_map<std::string, uint32_t> timestampLabelLookup;
+
+    VoteHistory(std::shared_ptr<Columns> columns, std::shared_ptr<StringTables> strings)
+        : columns(std::move(columns)), strings(std::move(strings)) {}
+
+public:
+    VoteHistory();
+    VoteHistory(const VoteHistory& other);
+    VoteHistory(VoteHistory&& other) noexcept;
+    VoteHistory& operator=(const VoteHistory& other);
+    VoteHistory& operator=(VoteHistory&& other) noexcept;
+
+    /**
+     * @brief Append one update
+     * @param district The district handle
+     * @param candidate The candidate handle
+     * @param delta The votes added
+     * @param precinct An id returned by internPrecinct()
+     * @param timestamp Nanoseconds since the epoch, or a code from encodeTimestamp()
+     */
+    void append(uint32_t district, uint32_t candidate, int64_t delta, uint32_t precinct, int64_t timestamp) {
+        size_t row = reserveRows(1);
+        setRow(row, district, candidate, delta, precinct, timestamp);
+        publishRows(row, 1);
+    }
+
+    /**
+     * @brief Claim n consecutive rows; safe from any thread
+     * @return The first claimed row
+     * @throws std::bad_alloc or std::length_error with nothing claimed
+     *
+     * The rows' chunks are allocated before they are claimed, so the
+     * setRow() and publishRows() calls that must follow cannot throw.
+     */
+    size_t reserveRows(size_t n) {
+        size_t first = reservedRows.load(std::memory_order_relaxed);
+        do {
+            preallocateRows(first, first + n);
+        } while (!reservedRows.compare_exchange_weak(first, first + n, std::memory_order_relaxed));
+        return first;
+    }
+
+    /**
+     * @brief Fill in a row claimed with reserveRows(); never throws
+     */
+    void setRow(size_t row, uint32_t district, uint32_t candidate, int64_t delta, uint32_t precinct,
+                int64_t timestamp) {
+        columns->district.slot(row) = district;
+        columns->candidate.slot(row) = candidate;
+        columns->precinct.slot(row) = precinct;
+        columns->timestamp.slot(row) = timestamp;
+        columns->delta.slot(row) = delta;
+    }
+
+    /**
+     * @brief Make rows [first, first + n) visible to readers
+     *
+     * Rows become visible in reservation order, so this waits for every
+     * earlier reservation to be published first.
+     */
+    void publishRows(size_t first, size_t n) {
+        while (publishedRows.load(std::memory_order_acquire) != first) {
+            std::this_thread::yield();
+        }
+        publishedRows.store(first + n, std::memory_order_release);
+    }
+
+    /**
+     * @brief Get the id of a precinct, adding it on first use
+     */
+    uint32_t internPrecinct(const std::string& precinctId);
+
+    /**
+     * @brief Get the id of a precinct without adding it
+     * @return The id, or UINT32_MAX if the precinct was never interned
+     */
+    uint32_t findPrecinct(const std::string& precinctId) const {
+        auto it = precinctLookup.find(precinctId);
+        return it == precinctLookup.end() ? UINT32_MAX : it->second;
+    }
+
+    /**
+     * @brief Get the precinct string behind an interned id
+     */
+    const std::string& getPrecinctId(uint32_t precinct) const { return strings->precinctIds[precinct]; }
+
+    /**
+     * @brief Get the number of interned precincts; ids run from 0 to this minus 1
+     */
+    size_t getPrecinctIdCount() const { return precinctIdCount; }
+
+    /**
+     * @brief Get the text of an interned timestamp label, by label id
+     */
+    const std::string& getTimestampLabel(uint32_t label) const { return strings->timestampLabels[label]; }
+
+    /**
+     * @brief Get the number of interned timestamp labels
+     */
+    size_t getTimestampLabelCount() const { return timestampLabelCount; }
+
+    /**
+     * @brief Convert a text timestamp into the timestamp column's encoding
+     * @return Nanoseconds for ctime-style text, a label code otherwise
+     */
+    int64_t encodeTimestamp(const std::string& text);
+
+    /**
+     * @brief Render a timestamp column value as text
+     * @return ctime-style local time, or the original label
+     * @throws std::out_of_range for a label code that was never handed out
+     */
+    std::string formatTimestamp(int64_t timestamp) const;
+
+    /**
+     * @brief Check whether a timestamp column value is a label code
+     */
+    static bool isLabel(int64_t timestamp) { return timestamp < kLabelLimit; }
+
+    /**
+     * @brief Check that a value is nanoseconds or a label code handed out by encodeTimestamp()
+     */
+    bool isValidTimestamp(int64_t timestamp) const {
+        return !isLabel(timestamp) || static_cast<uint64_t>(timestamp - kLabelBase) < timestampLabelCount;
+    }
+
+    /**
+     * @brief Parse ctime-style local time text
+     * @param text Text such as "Tue Nov  5 21:30:00 2024"
+     * @param nanoseconds Set to nanoseconds since the epoch on success
+     * @return True if the text was in ctime format
+     */
+    static bool parseClockTime(const std::string& text, int64_t& nanoseconds);
+
+    /**
+     * @brief Format nanoseconds since the epoch as ctime-style local time
+     */
+    static std::string formatClockTime(int64_t nanoseconds);
+
+    /**
+     * @brief Current time for the timestamp column, in nanoseconds since the epoch
+     *
+     * Reads steady_clock and adds an offset taken from system_clock on first
+     * use, so values never go backwards and cost no libc call or allocation.
+     * Long runs drift from wall-clock adjustments made after that point.
+     */
+    static int64_t nowNanoseconds();
+
+    /**
+     * @brief Get the number of published rows; safe from any thread
+     */
+    size_t size() const { return publishedRows.load(std::memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+
+    /**
+     * @brief Allocate the chunks for n updates in every column ahead of time
+     */
+    void reserve(size_t n);
+
+    /**
+     * @brief Allocate the chunks for rows [first, last) in every column
+     */
+    void preallocateRows(size_t first, size_t last);
+
+    /**
+     * @brief Remove every update (interned ids stay valid, chunks are kept for reuse unless shared)
+     */
+    void clear();
+
+    /**
+     * @brief Get a read-only view of the published rows and interned strings, without copying
+     *
+     * The view shares chunks with this history and stays valid while this
+     * one keeps appending, is cleared or is destroyed. Only the view's own
+     * rows and strings may be read through it; never write to it.
+     */
+    VoteHistory sharePrefix() const;
+
+    // Column access for scans that need only some fields; index below size()
+    const ChunkedArray<uint32_t>& districts() const { return columns->district; }
+    const ChunkedArray<uint32_t>& candidates() const { return columns->candidate; }
+    const ChunkedArray<uint32_t>& precincts() const { return columns->precinct; }
+    const ChunkedArray<int64_t>& timestamps() const { return columns->timestamp; }
+    const ChunkedArray<int64_t>& deltas() const { return columns->delta; }
+};
@@ -3,7 +3,62 @@
 #include <unordered_map>
 #include <vector>
 #include <memory>
+#include <limits>
+#include <algorithm>
+#include <iterator>
+#include <mutex>
 #include "fenwick_tree.hpp"
+#include "tally_store.hpp"
+#include "mapped_tally_store.hpp"
+#include "leader_tracker.hpp"
+#include "sharded_tally.hpp"
+#include "persistent_fenwick_tree.hpp"
+#include "vote_history.hpp"
+#include "precinct_index.hpp"
+#include "write_ahead_log.hpp"
+#include "checkpoint.hpp"
+
+/**
+ * @brief Dense integer handles for districts and candidates
+ * 
+ * Handles are assigned in insertion order (0, 1, 2, ...) and index directly
+ * into VoteManager's internal arrays, so calls that use them skip the
+ * string hashing done by the ID-based overloads.
+ */
+using DistrictHandle = uint32_t;
+using CandidateHandle = uint32_t;
+
+/**
+ * @brief Sentinel returned by handle lookups when the ID is unknown
+ */
+constexpr uint32_t kInvalidHandle = std::numeric_limits<uint32_t>::max();
+
+/**
+ * @brief Outcome of a non-throwing vote update
+ * 
+ * The try* ingestion calls return one of these instead of throwing, so a
+ * malformed feed costs a comparison rather than an unwind and a message.
+ */
+enum class VoteStatus : uint8_t {
+    Ok = 0,
+    UnknownDistrict,          ///< District handle out of range or ID not found
+    UnknownCandidate,         ///< Candidate handle out of range or ID not found
+    CandidateNotInDistrict,   ///< Candidate is not assigned to the district
+    DistrictFull,             ///< Candidate's slot is past the district's candidate count
+    UnknownPrecinct,          ///< Precinct id was not returned by internPrecinct()
+    InvalidTimestamp,         ///< Timestamp is a label code encodeTimestamp() never returned
+    ElectionClosed,           ///< Reported by ElectionSystem while the election is inactive
+    StorageError              ///< Reported by ElectionSystem when the log or tally file failed
+};
+
+/**
+ * @brief One entry of a batch whose votes come from different precincts
+ */
+struct PrecinctVote {
+    CandidateHandle candidate;
+    int64_t voteCount;
+    uint32_t precinct;  // From VoteManager::internPrecinct()
+};
 
 /**
  * @brief Represents a candidate in the election
@@ -44,6 +99,124 @@ struct VoteUpdate {
         : districtId(d), candidateId(c), voteCount(v), precinctId(p), timestamp(t) {}
 };
 
+/**
+ * @brief Read-only view of the vote history that builds VoteUpdates on demand
+ * 
+ * The history itself is columnar (see VoteHistory); this view turns a row
+ * back into a VoteUpdate with string IDs only when it is read. It stays
+ * valid as long as the VoteManager it came from.
+ */
+class VoteHistoryView {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = VoteUpdate;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = VoteUpdate;
+        
+        Iterator(const VoteHistoryView* view, size_t index) : view(view), index(index) {}
+        VoteUpdate operator*() const { return (*view)[index]; }
+        Iterator& operator++() { ++index; return *this; }
+        Iterator operator++(int) { Iterator previous = *this; ++index; return previous; }
+        bool operator==(const Iterator& other) const { return index == other.index; }
+        bool operator!=(const Iterator& other) const { return index != other.index; }
+        
+    private:
+        const VoteHistoryView* view;
+        size_t index;
+    };
+    
+    VoteHistoryView(const VoteHistory& history, const std::vector<District>& districts,
+                    const std::vector<Candidate>& candidates)
+        : history(&history), districts(&districts), candidates(&candidates) {}
+    
+    size_t size() const { return history->size(); }
+    bool empty() const { return history->empty(); }
+    
+    /**
+     * @brief Materialize one update
+     */
+    VoteUpdate operator[](size_t i) const;
+    VoteUpdate back() const { return (*this)[size() - 1]; }
+    
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, size()); }
+    
+    /**
+     * @brief Get the underlying columns
+     */
+    const VoteHistory& columns() const { return *history; }
+    
+private:
+    const VoteHistory* history;
+    const std::vector<District>* districts;
+    const std::vector<Candidate>* candidates;
+};
+
+/**
+ * @brief Immutable, versioned view of every tally
+ * 
+ * Published by VoteManager::publishSnapshot and handed out as a
+ * shared_ptr, so a reader can hold one for as long as it needs, reading
+ * mutually consistent totals while writers carry on. Rows that did not
+ * change between two publishes are shared by both snapshots, and each
+ * version is freed when its last reader lets go of it.
+ */
+class VoteSnapshot {
+public:
+    /**
+     * @brief Get the tally version this snapshot was taken at
+     */
+    uint64_t getVersion() const { return version; }
+    
+    /**
+     * @brief Get the number of districts in the snapshot
+     */
+    size_t getDistrictCount() const { return districtRows.size(); }
+    
+    /**
+     * @brief Get a candidate's votes in a district, 0 if unknown
+     */
+    int64_t getCandidateVotes(DistrictHandle district, CandidateHandle candidate) const;
+    
+    /**
+     * @brief Get every candidate's votes in a district, indexed by candidate handle
+     */
+    const std::vector<int64_t>& getDistrictVotes(DistrictHandle district) const;
+    
+    /**
+     * @brief Get total votes in a district, 0 if unknown
+     */
+    int64_t getDistrictTotalVotes(DistrictHandle district) const;
+    
+    /**
+     * @brief Get a candidate's votes across all districts, 0 if unknown
+     */
+    int64_t getCandidateTotalVotes(CandidateHandle candidate) const;
+    
+    /**
+     * @brief Get the leading candidate in a district, or kInvalidHandle if none
+     */
+    CandidateHandle getDistrictLeader(DistrictHandle district) const;
+    
+    /**
+     * @brief Get the overall leader, or kInvalidHandle if there are no candidates
+     */
+    CandidateHandle getOverallLeader() const { return overallLeader; }
+    
+private:
+    friend class VoteManager;
+    
+    uint64_t version = 0;
+    std::vector<std::shared_ptr<const std::vector<int64_t>>> districtRows;
+    std::vector<int64_t> districtTotals;
+    std::vector<CandidateHandle> districtLeaders;
+    std::vector<int64_t> candidateTotals;
+    CandidateHandle overallLeader = kInvalidHandle;
+};
+
 /**
  * @brief Manages vote counting operations using Fenwick Trees
  * 
@@ -55,32 +228,213 @@ struct VoteUpdate {
  */
 class VoteManager {
 private:
-    // District ID -> Fenwick Tree mapping
+    // District handle -> Fenwick Tree, in the selected storage layout
     // Each Fenwick Tree handles votes for all candidates in that district
-    std::unordered_map<std::string, std::unique_ptr<FenwickTree>> districtTrees;
+    TallyStorage storage;
+    std::unique_ptr<TallyStore> tallies;
+    
+    // District handle -> (candidate handle -> 1-based tree index, 0 if unassigned)
+    std::vector<std::vector<size_t>> candidateSlots;
+    
+    // District handle -> (tree index - 1 -> candidate handle)
+    std::vector<std::vector<CandidateHandle>> slotCandidates;
     
-    // Candidate ID -> index mapping within each district
-    std::unordered_map<std::string, std::unordered_map<std::string, size_t>> candidateIndices;
+    // District handle -> leader over that district's tree indices
+    // (empty for direct districts, whose leader is found by scanning the row)
+    std::vector<LeaderTracker> districtLeaders;
+    std::vector<bool> directDistricts;
     
-    // District and candidate information
+    // String ID -> handle lookups for the ID-based API
+    std::unordered_map<std::string, DistrictHandle> districtHandles;
+    std::unordered_map<std::string, CandidateHandle> candidateHandles;
+    
+    // Candidate handle -> votes across all districts, kept current by addVotes,
+    // with the national leader at the root
+    LeaderTracker candidateTotals;
+    
+    // District and candidate information (indexed by handle)
     std::vector<District> districts;
     std::vector<Candidate> candidates;
     
-    // Vote history for audit purposes
-    std::vector<VoteUpdate> voteHistory;
+    // Vote history for audit purposes, one column per field
+    VoteHistory voteHistory;
+    
+    // Per-precinct counters and per-district reporting bitmaps
+    PrecinctIndex precinctIndex;
+    
+    // Durable log of every accepted update (null unless enabled)
+    std::unique_ptr<WriteAheadLog> writeAheadLog;
+    
+    // Background checkpoint writer (null unless enabled); declared after the
+    // log so it is destroyed first and never waits on a closed log
+    std::unique_ptr<CheckpointWriter> checkpointWriter;
+    uint64_t checkpointInterval = 0;
+    uint64_t changesSinceCheckpoint = 0;
+    
+    // Bumped by every change made through the single-threaded update path
+    uint64_t tallyVersion = 0;
+    
+    // District handle -> every past version of its tallies (empty unless enabled)
+    std::vector<PersistentFenwickTree> versionedTallies;
+    bool versionTracking = false;
+    
+    // Clock time of each version stamped with one, in version order. Times
+    // are clamped so they never decrease, which keeps them binary-searchable.
+    struct VersionTime {
+        uint64_t version;
+        int64_t timestampNs;
+    };
+    std::vector<VersionTime> versionTimes;
+    uint64_t versionTimeBase = 0;  // Version for times before the first entry
+    
+    // Totals and leaders over the main tallies plus all shards, valid for one
+    // (tallyVersion, shard epoch) pair
+    struct MergedTotals {
+        uint64_t tallyVersion;
+        uint64_t shardEpoch;
+        std::vector<int64_t> districtTotals;
+        std::vector<CandidateHandle> districtLeaders;
+        std::vector<int64_t> candidateTotals;
+        CandidateHandle overallLeader;
+    };
+    
+    // Per-thread ingestion shards and the merged view cache (null until enabled)
+    struct ShardedState {
+        ShardedTally tally;
+        std::mutex mergeMutex;
+        std::shared_ptr<const MergedTotals> merged;
+        
+        ShardedState(const std::vector<size_t>& slotCounts, size_t shardCount)
+            : tally(slotCounts, shardCount) {}
+    };
+    std::unique_ptr<ShardedState> sharded;
+    
+    // Latest published snapshot, swapped atomically so readers never block
+    std::shared_ptr<const VoteSnapshot> publishedSnapshot;
+    uint64_t publishedShardEpoch = 0;
+    
+    // Districts whose rows changed since the last publish
+    std::vector<bool> dirtyDistricts;
+    bool allDistrictsDirty = false;
+
+    /**
+     * @brief Get the 1-based tree index of a candidate within a district
+     * @return The tree index, or 0 if the candidate is not assigned there
+     */
+    size_t slotOf(DistrictHandle district, CandidateHandle candidate) const {
+        const auto& slots = candidateSlots[district];
+        return candidate < slots.size() ? slots[candidate] : 0;
+    }
+    
+    /**
+     * @brief Check that a vote can be applied
+     * @param slot Set to the candidate's 1-based tree index on success
+     */
+    VoteStatus checkVote(DistrictHandle district, CandidateHandle candidate, size_t& slot) const {
+        if (district >= districts.size()) {
+            return VoteStatus::UnknownDistrict;
+        }
+        if (candidate >= candidates.size()) {
+            return VoteStatus::UnknownCandidate;
+        }
+        slot = slotOf(district, candidate);
+        if (slot == 0) {
+            return VoteStatus::CandidateNotInDistrict;
+        }
+        if (slot > districts[district].candidateCount) {
+            return VoteStatus::DistrictFull;
+        }
+        return VoteStatus::Ok;
+    }
+    
+    /**
+     * @brief Validate and apply a batch of votes in one district
+     * @param precinctOf Maps an entry index to its interned precinct; only
+     *        called once the whole batch has been validated
+     */
+    template <typename Vote, typename PrecinctOf>
+    VoteStatus applyVotes(DistrictHandle district, const std::vector<Vote>& votes,
+                          PrecinctOf precinctOf, int64_t timestampNs);
+    
+    /**
+     * @brief Index the version just reached under its clock time (version tracking only)
+     */
+    void recordVersionTime(int64_t timestampNs) {
+        if (!versionTracking || VoteHistory::isLabel(timestampNs)) {
+            return;
+        }
+        if (!versionTimes.empty()) {
+            timestampNs = std::max(timestampNs, versionTimes.back().timestampNs);
+        }
+        versionTimes.push_back({tallyVersion, timestampNs});
+    }
+    
+    /**
+     * @brief Throw the exception the throwing API uses for a failed status
+     */
+    [[noreturn]] void throwVoteError(VoteStatus status, DistrictHandle district, CandidateHandle candidate) const;
+    
+    /**
+     * @brief Get totals and leaders merged across the main tallies and all
+     * shards, rebuilding them only if a write happened since the last call
+     */
+    std::shared_ptr<const MergedTotals> mergedTotals() const;
+    
+    /**
+     * @brief Build a snapshot, copying rows only where the district is dirty
+     * @param base Snapshot to share clean rows with, or null to copy every row
+     */
+    std::shared_ptr<VoteSnapshot> buildSnapshot(const VoteSnapshot* base) const;
+    
+    /**
+     * @brief Count one change and hand a checkpoint to the writer when due
+     */
+    void checkpointIfDue();
 
 public:
+    /**
+     * @brief Construct an empty vote manager
+     * @param storage The storage backend for vote tallies
+     */
+    explicit VoteManager(TallyStorage storage = TallyStorage::Adaptive);
+    
+    /**
+     * @brief Construct a vote manager whose tallies live in a memory-mapped file
+     * @param tallyFile The file; an existing one is reopened as it is
+     * @param options When to write dirty pages back to disk
+     * 
+     * After a restart, adding the same districts and assigning the same
+     * candidates reattaches the stored tallies, and every query reflects
+     * them at once. The history is not part of the file. Do not also replay
+     * a write-ahead log into a reattached file: its votes are already in it.
+     */
+    explicit VoteManager(const std::string& tallyFile, MappedTallyOptions options = MappedTallyOptions());
+    
+    /**
+     * @brief Get the storage backend used for vote tallies
+     */
+    TallyStorage getTallyStorage() const { return storage; }
+    
+    /**
+     * @brief Get the mapped tally store, or null for in-memory storage
+     */
+    MappedTallyStore* getMappedTallyStore() const {
+        return storage == TallyStorage::Mapped ? static_cast<MappedTallyStore*>(tallies.get()) : nullptr;
+    }
+    
     /**
      * @brief Add a new district to the system
      * @param district The district to add
+     * @return The handle of the new district
      */
-    void addDistrict(const District& district);
+    DistrictHandle addDistrict(const District& district);
     
     /**
      * @brief Add a new candidate to the system
      * @param candidate The candidate to add
+     * @return The handle of the new candidate
      */
-    void addCandidate(const Candidate& candidate);
+    CandidateHandle addCandidate(const Candidate& candidate);
     
     /**
      * @brief Assign a candidate to a district
@@ -89,6 +443,27 @@ public:
      */
     void assignCandidateToDistrict(const std::string& districtId, const std::string& candidateId);
     
+    /**
+     * @brief Assign a candidate to a district by handle
+     * @param district The district handle
+     * @param candidate The candidate handle
+     */
+    void assignCandidateToDistrict(DistrictHandle district, CandidateHandle candidate);
+    
+    /**
+     * @brief Look up the handle of a district
+     * @param districtId The district ID
+     * @return The district handle, or kInvalidHandle if not found
+     */
+    DistrictHandle getDistrictHandle(const std::string& districtId) const;
+    
+    /**
+     * @brief Look up the handle of a candidate
+     * @param candidateId The candidate ID
+     * @return The candidate handle, or kInvalidHandle if not found
+     */
+    CandidateHandle getCandidateHandle(const std::string& candidateId) const;
+    
     /**
      * @brief Add votes for a candidate in a district
      * @param districtId The district ID
@@ -100,6 +475,150 @@ public:
     void addVotes(const std::string& districtId, const std::string& candidateId, 
                   int64_t voteCount, const std::string& precinctId, const std::string& timestamp);
     
+    /**
+     * @brief Add votes for a candidate in a district by handle
+     * @param district The district handle
+     * @param candidate The candidate handle
+     * @param voteCount The number of votes to add
+     * @param precinctId The precinct ID (for tracking)
+     * @param timestamp The timestamp of the update
+     * 
+     * Indexes straight into the per-district arrays, no string hashing.
+     */
+    void addVotes(DistrictHandle district, CandidateHandle candidate,
+                  int64_t voteCount, const std::string& precinctId, const std::string& timestamp);
+    
+    /**
+     * @brief Add votes for a candidate in a district by handle
+     * @param district The district handle
+     * @param candidate The candidate handle
+     * @param voteCount The number of votes to add
+     * @param precinctId The precinct ID (for tracking)
+     * @param timestampNs The time of the update in nanoseconds since the epoch
+     */
+    void addVotes(DistrictHandle district, CandidateHandle candidate,
+                  int64_t voteCount, const std::string& precinctId, int64_t timestampNs);
+    
+    /**
+     * @brief Add votes by handle, reporting bad input as a status
+     * @return VoteStatus::Ok if applied; otherwise nothing changed
+     * @throws std::runtime_error only if the write-ahead log or tally file fails
+     * 
+     * This is the ingestion fast path; the addVotes overloads wrap it and
+     * turn a failed status into an exception.
+     */
+    VoteStatus tryAddVotes(DistrictHandle district, CandidateHandle candidate,
+                           int64_t voteCount, const std::string& precinctId, int64_t timestampNs);
+    
+    /**
+     * @brief Add votes by district and candidate ID, reporting bad input as a status
+     */
+    VoteStatus tryAddVotes(const std::string& districtId, const std::string& candidateId,
+                           int64_t voteCount, const std::string& precinctId, int64_t timestampNs);
+    
+    /**
+     * @brief Add several candidates' votes in one district as a single batch
+     * @param district The district handle
+     * @param votes (candidate handle, vote count) pairs; a candidate may repeat
+     * @param precinctId The precinct ID (for tracking)
+     * @param timestamp The timestamp of the update
+     * 
+     * Every candidate is validated before anything is applied, so a bad entry
+     * leaves the tallies unchanged. The district tree is updated in one
+     * linear pass and one history record is kept per entry.
+     */
+    void addVotesBatch(DistrictHandle district,
+                       const std::vector<std::pair<CandidateHandle, int64_t>>& votes,
+                       const std::string& precinctId, const std::string& timestamp);
+    
+    /**
+     * @brief Add a batch of votes in one district with a nanosecond timestamp
+     */
+    void addVotesBatch(DistrictHandle district,
+                       const std::vector<std::pair<CandidateHandle, int64_t>>& votes,
+                       const std::string& precinctId, int64_t timestampNs);
+    
+    /**
+     * @brief Add a batch of votes, reporting the first bad entry as a status
+     * @return VoteStatus::Ok if applied; otherwise nothing changed
+     */
+    VoteStatus tryAddVotesBatch(DistrictHandle district,
+                                const std::vector<std::pair<CandidateHandle, int64_t>>& votes,
+                                const std::string& precinctId, int64_t timestampNs);
+    
+    /**
+     * @brief Add a batch of votes from several precincts in one district
+     * @param votes Entries with precinct ids from internPrecinct()
+     * @return VoteStatus::Ok if applied; otherwise nothing changed
+     * 
+     * The district tree is still updated in one pass, so a feed batch can
+     * be grouped by district alone rather than by district and precinct.
+     */
+    VoteStatus tryAddVotesBatch(DistrictHandle district, const std::vector<PrecinctVote>& votes,
+                                int64_t timestampNs);
+    
+    /**
+     * @brief Apply one precinct's report as a single transaction
+     * @param district The district the precinct belongs to
+     * @param precinctId The reporting precinct
+     * @param votes (candidate handle, vote count) pairs for every candidate reported
+     * @param timestampNs The time of the report in nanoseconds since the epoch
+     * @return VoteStatus::Ok if applied; otherwise nothing changed
+     * 
+     * Every entry is validated before anything is applied. The report then
+     * advances the tally version once and is logged as one write-ahead log
+     * record, so recovery replays all of it or none. No snapshot is
+     * published here: the writer publishes between changes, so any
+     * snapshot it publishes later has either none of the report or all of it.
+     */
+    VoteStatus applyPrecinctReport(DistrictHandle district, const std::string& precinctId,
+                                   const std::vector<std::pair<CandidateHandle, int64_t>>& votes,
+                                   int64_t timestampNs);
+    
+    /**
+     * @brief Check a vote without applying it
+     * @return The status tryAddVotes would return for this district and candidate
+     */
+    VoteStatus validateVote(DistrictHandle district, CandidateHandle candidate) const;
+    
+    /**
+     * @brief Get the id of a precinct, adding it on first use
+     */
+    uint32_t internPrecinct(const std::string& precinctId);
+    
+    /**
+     * @brief Allocate history space for this many more updates ahead of time
+     */
+    void reserveHistory(size_t additionalUpdates);
+    
+    /**
+     * @brief Split ingestion into per-thread shards that are merged on read
+     * @param shardCount The number of shards, one per ingestion thread
+     * 
+     * Districts must all be added first; candidates must be assigned before
+     * ingestion threads start. Afterwards every query includes the shards,
+     * and totals and leaders are cached until the next write.
+     */
+    void enableSharding(size_t shardCount);
+    
+    /**
+     * @brief Get the number of ingestion shards (0 if sharding is disabled)
+     */
+    size_t getShardCount() const { return sharded ? sharded->tally.getShardCount() : 0; }
+    
+    /**
+     * @brief Add votes through one ingestion shard
+     * @param shard The calling thread's shard index
+     * @param district The district handle
+     * @param candidate The candidate handle
+     * @param voteCount The number of votes to add
+     * 
+     * Threads may call this concurrently with distinct shard indices, and
+     * concurrently with queries. Writes touch only the caller's shard, so
+     * they never contend. Sharded writes are not recorded in the vote history.
+     */
+    void addVotesSharded(size_t shard, DistrictHandle district, CandidateHandle candidate, int64_t voteCount);
+    
     /**
      * @brief Get total votes for a candidate in a district
      * @param districtId The district ID
@@ -108,6 +627,23 @@ public:
      */
     int64_t getCandidateVotes(const std::string& districtId, const std::string& candidateId) const;
     
+    /**
+     * @brief Get total votes for a candidate in a district by handle
+     * @param district The district handle
+     * @param candidate The candidate handle
+     * @return Total votes for the candidate in the district, 0 if unknown
+     */
+    int64_t getCandidateVotes(DistrictHandle district, CandidateHandle candidate) const;
+    
+    /**
+     * @brief Get every candidate's votes in a district in one pass
+     * @param district The district handle
+     * @return Votes indexed by candidate handle (0 for candidates not in the district)
+     * 
+     * Time complexity: O(C), reads the district's tree once
+     */
+    std::vector<int64_t> getDistrictVotes(DistrictHandle district) const;
+    
     /**
      * @brief Get total votes for a candidate across all districts
      * @param candidateId The candidate ID
@@ -115,6 +651,15 @@ public:
      */
     int64_t getCandidateTotalVotes(const std::string& candidateId) const;
     
+    /**
+     * @brief Get total votes for a candidate across all districts by handle
+     * @param candidate The candidate handle
+     * @return Total votes for the candidate, 0 if unknown
+     * 
+     * Time complexity: O(1), totals are maintained incrementally
+     */
+    int64_t getCandidateTotalVotes(CandidateHandle candidate) const;
+    
     /**
      * @brief Get total votes in a district
      * @param districtId The district ID
@@ -122,24 +667,270 @@ public:
      */
     int64_t getDistrictTotalVotes(const std::string& districtId) const;
     
+    /**
+     * @brief Get total votes in a district by handle
+     * @param district The district handle
+     * @return Total votes in the district, 0 if unknown
+     */
+    int64_t getDistrictTotalVotes(DistrictHandle district) const;
+    
     /**
      * @brief Get the leading candidate in a district
      * @param districtId The district ID
      * @return The candidate ID with the most votes, or empty string if no votes
+     * 
+     * Time complexity: O(1). Ties go to the candidate assigned to the district first.
      */
     std::string getDistrictLeader(const std::string& districtId) const;
     
+    /**
+     * @brief Get the leading candidate in a district by handle
+     * @param district The district handle
+     * @return The leading candidate's handle, or kInvalidHandle if none
+     */
+    CandidateHandle getDistrictLeader(DistrictHandle district) const;
+    
     /**
      * @brief Get the overall election leader
      * @return The candidate ID with the most total votes, or empty string if no votes
+     * 
+     * Time complexity: O(1). Ties go to the candidate added first.
      */
     std::string getOverallLeader() const;
     
+    /**
+     * @brief Get the overall election leader's handle
+     * @return The leading candidate's handle, or kInvalidHandle if none
+     */
+    CandidateHandle getOverallLeaderHandle() const;
+    
+    /**
+     * @brief Log every accepted update to a binary write-ahead log
+     * @param path The log file; an existing log is continued
+     * @param options Group commit settings
+     * 
+     * Updates are logged after validation and before they are applied.
+     * Sharded writes are not logged.
+     */
+    void enableWriteAheadLog(const std::string& path, WalOptions options = WalOptions());
+    
+    /**
+     * @brief Get the write-ahead log, or null if logging is disabled
+     */
+    WriteAheadLog* getWriteAheadLog() const { return writeAheadLog.get(); }
+    
+    /**
+     * @brief Replay a write-ahead log into this manager
+     * @param path The log file
+     * @param afterSequence Skip records up to and including this sequence
+     * @return What was read, with records set to the number replayed; replay
+     * stops at a torn tail
+     * 
+     * Districts, candidates and assignments must be set up exactly as when
+     * the log was written. Call before enableWriteAheadLog.
+     */
+    WalReadResult recoverFromLog(const std::string& path, uint64_t afterSequence = 0);
+    
+    /**
+     * @brief Copy the complete tally state for a checkpoint (writer thread only)
+     * @return Districts, candidates, assignments, raw tallies, history and the
+     * write-ahead log sequence they include
+     * 
+     * Time complexity: O(D * C); the history is shared, not copied
+     */
+    std::shared_ptr<CheckpointData> captureCheckpoint() const;
+    
+    /**
+     * @brief Capture and write a checkpoint file now
+     * @param path The checkpoint file, replaced atomically
+     */
+    void writeCheckpoint(const std::string& path) const;
+    
+    /**
+     * @brief Write checkpoints in the background every updateInterval changes
+     * @param path The checkpoint file, replaced atomically each time
+     * @param updateInterval Changes (addVotes calls, batches, resets) between checkpoints
+     * 
+     * The writing thread only captures the state; encoding and I/O happen
+     * on the checkpoint thread. Enable the write-ahead log first so that
+     * restoreFromCheckpoint can replay the updates after each checkpoint.
+     */
+    void enableCheckpoints(const std::string& path, uint64_t updateInterval);
+    
+    /**
+     * @brief Get the background checkpoint writer, or null if disabled
+     */
+    CheckpointWriter* getCheckpointWriter() const { return checkpointWriter.get(); }
+    
+    /**
+     * @brief Rebuild this manager from a checkpoint plus the log tail after it
+     * @param checkpointPath The checkpoint file
+     * @param walPath The write-ahead log the checkpoint was taken against
+     * @return What was read from the log; records is the number replayed
+     * @throws std::logic_error unless this manager is empty
+     * @throws std::runtime_error if the checkpoint is missing or corrupt
+     * 
+     * Districts, candidates and assignments come from the checkpoint, so no
+     * setup is needed. Only log records newer than the checkpoint are replayed.
+     */
+    WalReadResult restoreFromCheckpoint(const std::string& checkpointPath, const std::string& walPath);
+    
+    /**
+     * @brief Keep every version of the tallies for point-in-time queries
+     * 
+     * Versions start at the current one; earlier ones are not recoverable.
+     * Each update then also costs an O(log n) append. Sharded writes are
+     * not versioned.
+     */
+    void enableVersionTracking();
+    
+    /**
+     * @brief Check whether point-in-time queries are available
+     */
+    bool isVersionTracking() const { return versionTracking; }
+    
+    /**
+     * @brief Get the current tally version
+     * 
+     * Every addVotes call, batch and reset advances the version by one, so
+     * version N is the state after the N-th change.
+     */
+    uint64_t getCurrentVersion() const { return tallyVersion; }
+    
+    /**
+     * @brief Get the oldest version still available to point-in-time queries
+     */
+    uint64_t getOldestVersion() const;
+    
+    /**
+     * @brief Get a candidate's votes in a district as of a past version
+     * @param district The district handle
+     * @param candidate The candidate handle
+     * @param version A version between getOldestVersion() and getCurrentVersion()
+     * @return The votes at that version, 0 if the candidate is not in the district
+     * 
+     * Time complexity: O(log C * log V), no history replay
+     */
+    int64_t getCandidateVotesAt(DistrictHandle district, CandidateHandle candidate, uint64_t version) const;
+    
+    /**
+     * @brief Get a candidate's votes in a district as of a past version by ID
+     */
+    int64_t getCandidateVotesAt(const std::string& districtId, const std::string& candidateId,
+                                uint64_t version) const;
+    
+    /**
+     * @brief Get total votes in a district as of a past version
+     */
+    int64_t getDistrictTotalVotesAt(DistrictHandle district, uint64_t version) const;
+    
+    /**
+     * @brief Get the version that was current at a clock time
+     * @param timestampNs Nanoseconds since the epoch
+     * @return The newest version stamped at or before that time
+     * @throws std::logic_error if version tracking is not enabled
+     * 
+     * Pass the result to the *At queries for "results as of 21:30".
+     * Versions without a clock time (resets and label-stamped updates)
+     * show up with the next stamped version. An update stamped earlier
+     * than one before it counts as happening at the earlier one's time.
+     * Times before the oldest kept version give the oldest version.
+     * 
+     * Time complexity: O(log V)
+     */
+    uint64_t getVersionAt(int64_t timestampNs) const;
+    
+    /**
+     * @brief Get the version that was current at a ctime-style local time
+     * @throws std::invalid_argument if the text is not in ctime format
+     */
+    uint64_t getVersionAt(const std::string& clockTime) const;
+    
+    /**
+     * @brief Drop versions older than a checkpoint to bound memory
+     * @param checkpoint The oldest version that must stay queryable
+     */
+    void compactVersions(uint64_t checkpoint);
+    
+    /**
+     * @brief Get the latest published snapshot; safe from any thread
+     * @return An immutable view, version 0 and empty before the first publish
+     * 
+     * Never blocks on writers; call publishSnapshot from the writing thread
+     * to make newer votes visible.
+     */
+    std::shared_ptr<const VoteSnapshot> snapshot() const;
+    
+    /**
+     * @brief Publish a snapshot of the current tallies (writer thread only)
+     * @return The published snapshot
+     * 
+     * Does nothing if nothing changed since the last publish. Otherwise only
+     * the rows of districts updated since then are copied; the rest are
+     * shared with the previous snapshot.
+     */
+    std::shared_ptr<const VoteSnapshot> publishSnapshot();
+    
+    /**
+     * @brief Declare a precinct before it reports, so it counts as not yet reporting
+     * @return The precinct's handle; an existing precinct keeps its handle and votes
+     * @throws std::out_of_range if the district handle is invalid
+     * 
+     * Precincts that send votes without being declared are added on their
+     * first update. The same precinct ID in two districts is two precincts.
+     * New declarations go to the write-ahead log, and checkpoints keep them.
+     */
+    PrecinctHandle addPrecinct(DistrictHandle district, const std::string& precinctId);
+    
+    /**
+     * @brief Look up a precinct of a district
+     * @return The handle, or PrecinctIndex::npos if the district has no such precinct
+     */
+    PrecinctHandle getPrecinctHandle(DistrictHandle district, const std::string& precinctId) const;
+    
+    /**
+     * @brief Get a candidate's votes in one precinct, 0 if not on the district's ballot
+     * @throws std::out_of_range if the precinct handle is invalid
+     */
+    int64_t getPrecinctVotes(PrecinctHandle precinct, CandidateHandle candidate) const;
+    
+    /**
+     * @brief Get the total votes counted in one precinct
+     * @throws std::out_of_range if the precinct handle is invalid
+     */
+    int64_t getPrecinctTotalVotes(PrecinctHandle precinct) const;
+    
+    /**
+     * @brief Check whether a precinct has sent any update since the last reset
+     * @throws std::out_of_range if the precinct handle is invalid
+     */
+    bool isPrecinctReported(PrecinctHandle precinct) const;
+    
+    /**
+     * @brief Get the number of precincts known in a district
+     * @throws std::out_of_range if the district handle is invalid
+     */
+    size_t getPrecinctCount(DistrictHandle district) const;
+    
+    /**
+     * @brief Get the number of a district's precincts that have reported
+     * @throws std::out_of_range if the district handle is invalid
+     */
+    size_t getReportedPrecinctCount(DistrictHandle district) const;
+    
+    /**
+     * @brief Get the precinct table, for scans over a district's precincts
+     * 
+     * Votes applied through addVotesSharded carry no precinct and are not
+     * counted here, and neither are votes already in a reopened tally file.
+     */
+    const PrecinctIndex& getPrecinctIndex() const { return precinctIndex; }
+    
     /**
      * @brief Get vote history for audit purposes
-     * @return Vector of vote updates
+     * @return A view that builds each VoteUpdate when it is read
      */
-    const std::vector<VoteUpdate>& getVoteHistory() const { return voteHistory; }
+    VoteHistoryView getVoteHistory() const { return VoteHistoryView(voteHistory, districts, candidates); }
     
     /**
      * @brief Get all districts
@@ -163,4 +954,11 @@ public:
      * @return Formatted string with election results
      */
     std::string getDetailedResults() const;
+    
+    /**
+     * @brief Get detailed results for all districts as of a snapshot
+     * @param view The snapshot to render
+     * @return Formatted string with election results
+     */
+    std::string getDetailedResults(const VoteSnapshot& view) const;
 };
@@ -0,0 +1,216 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief CRC32C (Castagnoli) checksum, hardware-accelerated when built with SSE4.2
+ * @param data The bytes to checksum
+ * @param length The number of bytes
+ * @param crc A previous result to continue from, 0 to start
+ */
+uint32_t crc32c(const void* data, size_t length, uint32_t crc = 0);
+
+/**
+ * @brief Group commit settings for WriteAheadLog
+ */
+struct WalOptions {
+    // Longest an appended record waits before the flusher writes it out
+    std::chrono::microseconds flushWindow{2000};
+    // Buffered bytes that trigger a write before the window ends
+    size_t maxBatchBytes = 1 << 20;
+    // Sync each group to stable storage (fdatasync / _commit)
+    bool syncToDisk = true;
+};
+
+/**
+ * @brief One entry of a batch record
+ */
+struct WalBatchEntry {
+    uint32_t candidate;
+    int64_t delta;
+    std::string precinctId;
+};
+
+/**
+ * @brief One decoded log record
+ */
+struct WalRecord {
+    enum class Type : uint8_t { Vote = 1, Reset = 2, Batch = 3, Precinct = 4 };
+
+    Type type;
+    uint64_t sequence;
+    uint32_t district = 0;       // Vote, Batch and Precinct
+    uint32_t candidate = 0;
+    int64_t delta = 0;
+    int64_t timestampNs = 0;
+    std::string precinctId;      // Vote and Precinct
+    std::string timestampLabel;  // Set instead of timestampNs for free-form timestamps
+    std::vector<WalBatchEntry> entries;  // Batch only: every entry, all in district
+};
+
+/**
+ * @brief Outcome of reading a log file
+ */
+struct WalReadResult {
+    uint64_t records = 0;       // Vote, batch, precinct and reset records delivered
+    uint64_t lastSequence = 0;  // Sequence of the last delivered record
+    uint64_t validBytes = 0;    // Length of the intact prefix of the file
+    bool tornTail = false;      // True if trailing bytes failed the length or CRC check
+};
+
+/**
+ * @brief Append-only binary log of vote updates with group commit
+ *
+ * Every record is framed as [u32 payload length][u32 CRC32C of payload]
+ * [payload], little-endian. A payload starts with a type byte; votes
+ * carry a sequence number, handles, delta, timestamp and an interned
+ * precinct id. A batch is one record with one sequence number, so it is
+ * replayed whole or, if torn, not at all. A precinct record declares a
+ * precinct before it reports. Precinct ids and free-form
+ * timestamp labels are written once as definition records the first time
+ * they appear.
+ *
+ * append*() only copies the record into a memory buffer. A background
+ * flusher writes the buffer out and syncs it once per flush window (or
+ * sooner when maxBatchBytes accumulate), so one fdatasync covers every
+ * update appended in that window. waitDurable() blocks until a given
+ * sequence is on disk; flush() forces a write immediately.
+ *
+ * Opening an existing log continues it: a torn or corrupt tail left by a
+ * crash is truncated, and sequence numbers carry on from the last record.
+ */
+class WriteAheadLog {
+public:
+    /**
+     * @brief Open or create a log file and start the flusher thread
+     * @throws std::runtime_error if the file cannot be opened
+     */
+    explicit WriteAheadLog(const std::string& path, WalOptions options = WalOptions());
+
+    /**
+     * @brief Flush everything appended and close the file
+     */
+    ~WriteAheadLog();
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    /**
+     * @brief Append a vote update
+     * @param timestampLabel Non-empty for a free-form timestamp, which replaces timestampNs
+     * @return The record's sequence number
+     */
+    uint64_t appendVote(uint32_t district, uint32_t candidate, int64_t delta,
+                        const std::string& precinctId, int64_t timestampNs,
+                        const std::string& timestampLabel = std::string());
+
+    /**
+     * @brief Append a batch of votes in one district as a single record
+     * @param timestampLabel Non-empty for a free-form timestamp, which replaces timestampNs
+     * @return The record's sequence number
+     */
+    uint64_t appendBatch(uint32_t district, const std::vector<WalBatchEntry>& entries, int64_t timestampNs,
+                         const std::string& timestampLabel = std::string());
+
+    /**
+     * @brief Append the declaration of a precinct that has not reported yet
+     * @return The record's sequence number
+     */
+    uint64_t appendPrecinct(uint32_t district, const std::string& precinctId);
+
+    /**
+     * @brief Append a reset of every tally
+     * @return The record's sequence number
+     */
+    uint64_t appendReset();
+
+    /**
+     * @brief Write out and sync everything appended so far, now
+     */
+    void flush();
+
+    /**
+     * @brief Block until the record with the given sequence is durable
+     */
+    void waitDurable(uint64_t sequence);
+
+    /**
+     * @brief Get the sequence of the last record appended
+     */
+    uint64_t getLastSequence() const;
+
+    /**
+     * @brief Get the sequence of the last record known to be on disk
+     */
+    uint64_t getDurableSequence() const;
+
+    /**
+     * @brief Get the number of write + sync rounds so far
+     */
+    uint64_t getSyncCount() const;
+
+    /**
+     * @brief Get the path of the log file
+     */
+    const std::string& getPath() const { return path; }
+
+    /**
+     * @brief Read every intact record of a log file in order
+     * @param path The log file
+     * @param visit Called for each vote, batch, precinct or reset record
+     * @return Counts and where the intact prefix ends; stops at the first torn record
+     */
+    static WalReadResult read(const std::string& path, const std::function<void(const WalRecord&)>& visit);
+
+private:
+    enum class DefinitionType : uint8_t { Precinct = 16, TimestampLabel = 17 };
+
+    std::string path;
+    WalOptions options;
+    int fd = -1;
+
+    mutable std::mutex mutex;
+    std::condition_variable flushNeeded;
+    std::condition_variable durableChanged;
+    std::vector<unsigned char> pending;
+    uint64_t lastSequence = 0;
+    uint64_t durableSequence = 0;
+    uint64_t syncCount = 0;
+    bool flushRequested = false;
+    bool stopping = false;
+    bool failed = false;
+    std::thread flusher;
+
+    std::unordered_map<std::string, uint32_t> precinctIds;
+    std::unordered_map<std::string, uint32_t> timestampLabels;
+
+    /**
+     * @brief Reserve a frame header in the pending buffer (mutex held)
+     * @return Where the frame starts; encode the payload after it
+     */
+    size_t beginFrame();
+
+    /**
+     * @brief Fill in the length and CRC of the frame started at start (mutex held)
+     */
+    void endFrame(size_t start);
+
+    /**
+     * @brief Return the id of a string, writing its definition first if new (mutex held)
+     */
+    uint32_t define(std::unordered_map<std::string, uint32_t>& table, DefinitionType type,
+                    const std::string& text);
+
+    /**
+     * @brief Flusher thread body
+     */
+    void flushLoop();
+};
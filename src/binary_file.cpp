@@ -0,0 +1,237 @@
+#include "binary_file.hpp"
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+using namespace std;
+
+void ByteReader::need(size_t bytes) const {
+    if (bytes > size - offset) {
+        throw std::runtime_error("Unexpected end of binary data");
+    }
+}
+
+int openAppendFile(const std::string& path) {
+#ifdef _WIN32
+    return _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_BINARY | _O_APPEND, _S_IREAD | _S_IWRITE);
+#else
+    return ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+#endif
+}
+
+int openWriteFile(const std::string& path) {
+#ifdef _WIN32
+    return _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_BINARY | _O_TRUNC, _S_IREAD | _S_IWRITE);
+#else
+    return ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+}
+
+bool truncateFile(int fd, uint64_t length) {
+#ifdef _WIN32
+    return _chsize_s(fd, static_cast<__int64>(length)) == 0;
+#else
+    return ::ftruncate(fd, static_cast<off_t>(length)) == 0;
+#endif
+}
+
+bool writeFully(int fd, const unsigned char* data, size_t length) {
+    while (length > 0) {
+#ifdef _WIN32
+        int written = _write(fd, data, static_cast<unsigned int>(length));
+#else
+        ssize_t written = ::write(fd, data, length);
+#endif
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool syncFile(int fd) {
+#if defined(_WIN32)
+    return _commit(fd) == 0;
+#elif defined(__APPLE__)
+    return ::fsync(fd) == 0;
+#else
+    return ::fdatasync(fd) == 0;
+#endif
+}
+
+void closeFile(int fd) {
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+bool replaceFile(const std::string& source, const std::string& target) {
+#ifdef _WIN32
+    return MoveFileExA(source.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(source.c_str(), target.c_str()) == 0;
+#endif
+}
+
+bool readFile(const std::string& path, std::vector<unsigned char>& bytes) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        return false;
+    }
+    // One read of the known size instead of a byte-at-a-time copy
+    std::streamoff length = in.tellg();
+    bytes.resize(static_cast<size_t>(length));
+    in.seekg(0);
+    return in.read(reinterpret_cast<char*>(bytes.data()), length).good() || length == 0;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#ifdef _WIN32
+
+size_t MappedFile::open(const std::string& path, size_t minSize) {
+    close();
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                              OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Cannot open mapped file: " + path);
+    }
+    LARGE_INTEGER existing;
+    if (!GetFileSizeEx(file, &existing)) {
+        CloseHandle(file);
+        throw std::runtime_error("Cannot read mapped file size: " + path);
+    }
+    fileHandle = file;
+    length = std::max(static_cast<size_t>(existing.QuadPart), minSize);
+    map();
+    return static_cast<size_t>(existing.QuadPart);
+}
+
+void MappedFile::map() {
+    // Mapping past the end of the file extends it with zeros
+    ULARGE_INTEGER size;
+    size.QuadPart = length;
+    HANDLE mapping = CreateFileMappingA(static_cast<HANDLE>(fileHandle), nullptr, PAGE_READWRITE,
+                                        size.HighPart, size.LowPart, nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, length) : nullptr;
+    if (!view) {
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        throw std::runtime_error("Cannot map file");
+    }
+    mappingHandle = mapping;
+    bytes = static_cast<unsigned char*>(view);
+}
+
+void MappedFile::unmap() {
+    if (bytes) {
+        UnmapViewOfFile(bytes);
+        CloseHandle(static_cast<HANDLE>(mappingHandle));
+        bytes = nullptr;
+        mappingHandle = nullptr;
+    }
+}
+
+bool MappedFile::sync(size_t offset, size_t bytesToSync) {
+    return FlushViewOfFile(bytes + offset, bytesToSync) &&
+           FlushFileBuffers(static_cast<HANDLE>(fileHandle));
+}
+
+void MappedFile::close() {
+    unmap();
+    if (fileHandle) {
+        CloseHandle(static_cast<HANDLE>(fileHandle));
+        fileHandle = nullptr;
+    }
+    length = 0;
+}
+
+#else
+
+size_t MappedFile::open(const std::string& path, size_t minSize) {
+    close();
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open mapped file: " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        close();
+        throw std::runtime_error("Cannot read mapped file size: " + path);
+    }
+    size_t existing = static_cast<size_t>(info.st_size);
+    length = std::max(existing, minSize);
+    if (length > existing && ::ftruncate(fd, static_cast<off_t>(length)) != 0) {
+        close();
+        throw std::runtime_error("Cannot grow mapped file: " + path);
+    }
+    map();
+    return existing;
+}
+
+void MappedFile::map() {
+    void* view = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        throw std::runtime_error("Cannot map file");
+    }
+    bytes = static_cast<unsigned char*>(view);
+}
+
+void MappedFile::unmap() {
+    if (bytes) {
+        ::munmap(bytes, length);
+        bytes = nullptr;
+    }
+}
+
+bool MappedFile::sync(size_t offset, size_t bytesToSync) {
+    // msync needs a page-aligned start
+    size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t start = offset / page * page;
+    return ::msync(bytes + start, offset + bytesToSync - start, MS_SYNC) == 0;
+}
+
+void MappedFile::close() {
+    unmap();
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    length = 0;
+}
+
+#endif
+
+void MappedFile::resize(size_t newSize) {
+    if (newSize <= length) {
+        return;
+    }
+    unmap();
+#ifndef _WIN32
+    if (::ftruncate(fd, static_cast<off_t>(newSize)) != 0) {
+        map();
+        throw std::runtime_error("Cannot grow mapped file");
+    }
+#endif
+    length = newSize;
+    map();
+}
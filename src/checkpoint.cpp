@@ -0,0 +1,234 @@
+#include "checkpoint.hpp"
+#include "binary_file.hpp"
+#include "write_ahead_log.hpp"
+#include <cstdio>
+#include <stdexcept>
+using namespace std;
+
+namespace {
+
+constexpr uint32_t kCheckpointMagic = 0x54504B43;  // "CKPT"
+constexpr uint32_t kCheckpointFormat = 2;  // 2 added the precinct table; 1 is still read
+
+} // namespace
+
+void writeCheckpointFile(const std::string& path, const CheckpointData& data) {
+    const VoteHistory& history = data.history;
+    std::vector<unsigned char> out;
+    out.reserve(64 + history.size() * 28 + data.districts.size() * 64);
+
+    putU32(out, kCheckpointMagic);
+    putU32(out, kCheckpointFormat);
+    putU64(out, data.walSequence);
+    putU64(out, data.tallyVersion);
+
+    putU32(out, static_cast<uint32_t>(data.candidates.size()));
+    for (const auto& candidate : data.candidates) {
+        putString(out, candidate.name);
+        putString(out, candidate.party);
+        putString(out, candidate.id);
+    }
+
+    putU32(out, static_cast<uint32_t>(data.districts.size()));
+    for (const auto& district : data.districts) {
+        putString(out, district.name);
+        putString(out, district.id);
+        putU64(out, district.candidateCount);
+        putU32(out, static_cast<uint32_t>(district.assigned.size()));
+        for (uint32_t candidate : district.assigned) {
+            putU32(out, candidate);
+        }
+        putU32(out, static_cast<uint32_t>(district.values.size()));
+        for (int64_t value : district.values) {
+            putU64(out, static_cast<uint64_t>(value));
+        }
+    }
+
+    putU32(out, static_cast<uint32_t>(history.getPrecinctIdCount()));
+    for (uint32_t precinct = 0; precinct < history.getPrecinctIdCount(); ++precinct) {
+        putString(out, history.getPrecinctId(precinct));
+    }
+    putU32(out, static_cast<uint32_t>(history.getTimestampLabelCount()));
+    for (uint32_t label = 0; label < history.getTimestampLabelCount(); ++label) {
+        putString(out, history.getTimestampLabel(label));
+    }
+    putU64(out, history.size());
+    for (size_t i = 0; i < history.size(); ++i) {
+        putU32(out, history.districts()[i]);
+        putU32(out, history.candidates()[i]);
+        putU32(out, history.precincts()[i]);
+        putU64(out, static_cast<uint64_t>(history.timestamps()[i]));
+        putU64(out, static_cast<uint64_t>(history.deltas()[i]));
+    }
+
+    putU32(out, static_cast<uint32_t>(data.precincts.size()));
+    for (const auto& precinct : data.precincts) {
+        putU32(out, precinct.district);
+        putU32(out, precinct.precinctId);
+    }
+
+    putU32(out, crc32c(out.data(), out.size()));
+
+    // Write and sync a temporary file, then swap it in
+    std::string temporary = path + ".tmp";
+    int fd = openWriteFile(temporary);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open checkpoint file: " + temporary);
+    }
+    bool ok = writeFully(fd, out.data(), out.size()) && syncFile(fd);
+    closeFile(fd);
+    if (!ok || !replaceFile(temporary, path)) {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Cannot write checkpoint file: " + path);
+    }
+}
+
+CheckpointData readCheckpointFile(const std::string& path) {
+    std::vector<unsigned char> bytes;
+    if (!readFile(path, bytes)) {
+        throw std::runtime_error("Cannot open checkpoint file: " + path);
+    }
+    if (bytes.size() < 12 || getU32(bytes.data()) != kCheckpointMagic) {
+        throw std::runtime_error("Not a checkpoint file: " + path);
+    }
+    size_t bodyEnd = bytes.size() - 4;
+    if (crc32c(bytes.data(), bodyEnd) != getU32(bytes.data() + bodyEnd)) {
+        throw std::runtime_error("Checkpoint checksum mismatch: " + path);
+    }
+
+    ByteReader in(bytes.data() + 4, bodyEnd - 4);
+    uint32_t format = in.u32();
+    if (format != 1 && format != kCheckpointFormat) {
+        throw std::runtime_error("Unsupported checkpoint format: " + path);
+    }
+
+    CheckpointData data;
+    data.walSequence = in.u64();
+    data.tallyVersion = in.u64();
+
+    data.candidates.resize(in.u32());
+    for (auto& candidate : data.candidates) {
+        candidate.name = in.string();
+        candidate.party = in.string();
+        candidate.id = in.string();
+    }
+
+    data.districts.resize(in.u32());
+    for (auto& district : data.districts) {
+        district.name = in.string();
+        district.id = in.string();
+        district.candidateCount = in.u64();
+        district.assigned.resize(in.u32());
+        for (auto& candidate : district.assigned) {
+            candidate = in.u32();
+        }
+        district.values.resize(in.u32());
+        for (auto& value : district.values) {
+            value = in.i64();
+        }
+    }
+
+    // Interning in file order reproduces the original ids. Labels never
+    // parse as clock times, so encodeTimestamp interns each one.
+    VoteHistory& history = data.history;
+    for (uint32_t count = in.u32(), i = 0; i < count; ++i) {
+        history.internPrecinct(in.string());
+    }
+    for (uint32_t count = in.u32(), i = 0; i < count; ++i) {
+        history.encodeTimestamp(in.string());
+    }
+    uint64_t rows = in.u64();
+    history.reserve(static_cast<size_t>(rows));
+    for (uint64_t i = 0; i < rows; ++i) {
+        uint32_t district = in.u32();
+        uint32_t candidate = in.u32();
+        uint32_t precinct = in.u32();
+        int64_t timestamp = in.i64();
+        history.append(district, candidate, in.i64(), precinct, timestamp);
+    }
+
+    if (format >= 2) {
+        data.precincts.resize(in.u32());
+        for (auto& precinct : data.precincts) {
+            precinct.district = in.u32();
+            precinct.precinctId = in.u32();
+        }
+    }
+
+    if (in.remaining() != 0) {
+        throw std::runtime_error("Trailing data in checkpoint file: " + path);
+    }
+    return data;
+}
+
+CheckpointWriter::CheckpointWriter(const std::string& path, WriteAheadLog* wal)
+    : path(path), wal(wal), worker(&CheckpointWriter::writeLoop, this) {
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workReady.notify_one();
+    worker.join();
+}
+
+void CheckpointWriter::submit(std::shared_ptr<const CheckpointData> data) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued = std::move(data);
+    }
+    workReady.notify_one();
+}
+
+void CheckpointWriter::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    workDone.wait(lock, [&]() { return !queued && !writing; });
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+}
+
+uint64_t CheckpointWriter::getWrittenCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return writtenCount;
+}
+
+uint64_t CheckpointWriter::getWrittenSequence() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return writtenSequence;
+}
+
+void CheckpointWriter::writeLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        workReady.wait(lock, [&]() { return stopping || queued; });
+        if (!queued) {
+            break; // Stopping with nothing left to write
+        }
+
+        std::shared_ptr<const CheckpointData> data = std::move(queued);
+        queued.reset();
+        writing = true;
+        lock.unlock();
+        std::string failure;
+        try {
+            if (wal) {
+                wal->waitDurable(data->walSequence);
+            }
+            writeCheckpointFile(path, *data);
+        } catch (const std::exception& e) {
+            failure = e.what();
+        }
+        lock.lock();
+
+        writing = false;
+        error = failure;
+        if (failure.empty()) {
+            ++writtenCount;
+            writtenSequence = data->walSequence;
+        }
+        workDone.notify_all();
+    }
+}
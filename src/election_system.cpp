@@ -4,12 +4,18 @@
 #include <iomanip>
 #include <random>
 #include <chrono>
-#include <ctime>
 using namespace std;
 
+// Most updates the applier takes off the queue before applying them
+static constexpr size_t kMaxDrainBatch = 1024;
+
 // constructor , b intializie el values el 3ndi
-ElectionSystem::ElectionSystem(const std::string& name, const std::string& date)
-    : voteManager(std::make_unique<VoteManager>()), electionName(name), electionDate(date), isActive(false) {
+ElectionSystem::ElectionSystem(const std::string& name, const std::string& date, TallyStorage storage)
+    : voteManager(std::make_unique<VoteManager>(storage)), electionName(name), electionDate(date), isActive(false) {
+}
+
+ElectionSystem::~ElectionSystem() {
+    stopIngestion();
 }
 
 // function b setupElection
@@ -20,28 +26,49 @@ void ElectionSystem::setupElection(const std::vector<std::string>& districtNames
         throw std::invalid_argument("Number of candidates must match number of parties");
     }
     
-    // Add districts
+    std::lock_guard<std::mutex> lock(managerMutex);
+    
+    // Add districts; IDs continue after those of an earlier call
+    std::vector<DistrictHandle> districtHandles;
+    districtsByName.reserve(districtsByName.size() + districtNames.size());
+    size_t firstDistrict = voteManager->getDistricts().size();
     for (size_t i = 0; i < districtNames.size(); ++i) {
-        std::string districtId = "D" + std::to_string(i + 1);
+        std::string districtId = "D" + std::to_string(firstDistrict + i + 1);
         District district(districtNames[i], districtId, candidateNames.size());
-        voteManager->addDistrict(district);
+        districtHandles.push_back(voteManager->addDistrict(district));
+        // First district with a given name wins, matching the old linear search
+        districtsByName.emplace(districtNames[i], districtHandles.back());
     }
     
     // Add candidates
+    std::vector<CandidateHandle> candidateHandles;
+    candidatesByName.reserve(candidatesByName.size() + candidateNames.size());
+    size_t firstCandidate = voteManager->getCandidates().size();
     for (size_t i = 0; i < candidateNames.size(); ++i) {
-        std::string candidateId = "C" + std::to_string(i + 1);
+        std::string candidateId = "C" + std::to_string(firstCandidate + i + 1);
         Candidate candidate(candidateNames[i], partyNames[i], candidateId);
-        voteManager->addCandidate(candidate);
+        candidateHandles.push_back(voteManager->addCandidate(candidate));
+        candidatesByName.emplace(candidateNames[i], candidateHandles.back());
     }
     
     // Assign all candidates to all districts
-    for (const auto& district : voteManager->getDistricts()) {
-        for (const auto& candidate : voteManager->getCandidates()) {
-            voteManager->assignCandidateToDistrict(district.id, candidate.id);
+    for (DistrictHandle district : districtHandles) {
+        for (CandidateHandle candidate : candidateHandles) {
+            voteManager->assignCandidateToDistrict(district, candidate);
         }
     }
 }
 
+DistrictHandle ElectionSystem::findDistrict(const std::string& districtName) const {
+    auto it = districtsByName.find(districtName);
+    return it == districtsByName.end() ? kInvalidHandle : it->second;
+}
+
+CandidateHandle ElectionSystem::findCandidate(const std::string& candidateName) const {
+    auto it = candidatesByName.find(candidateName);
+    return it == candidatesByName.end() ? kInvalidHandle : it->second;
+}
+
 bool ElectionSystem::processVoteUpdate(const std::string& districtName,
                                        const std::string& candidateName,
                                        int64_t voteCount,
@@ -50,63 +77,368 @@ bool ElectionSystem::processVoteUpdate(const std::string& districtName,
         return false;
     }
     
-    try {
-        // Find district by name
-        auto districts = voteManager->getDistricts();
-        auto districtIt = std::find_if(districts.begin(), districts.end(),
-            [&districtName](const District& d) { return d.name == districtName; });
+    // Unknown names and bad assignments come back as statuses, not exceptions
+    DistrictHandle district = findDistrict(districtName);
+    CandidateHandle candidate = findCandidate(candidateName);
+    if (district == kInvalidHandle || candidate == kInvalidHandle) {
+        return false;
+    }
+    
+    // Stored as nanoseconds; text is only produced when history is read
+    int64_t timestampNs = VoteHistory::nowNanoseconds();
+    
+    std::lock_guard<std::mutex> lock(managerMutex);
+    return voteManager->tryAddVotes(district, candidate, voteCount, precinctId, timestampNs) == VoteStatus::Ok;
+}
+
+std::vector<VoteStatus> ElectionSystem::processVoteUpdates(const std::vector<VoteUpdateRequest>& updates) {
+    if (!isActive) {
+        return std::vector<VoteStatus>(updates.size(), VoteStatus::ElectionClosed);
+    }
+    
+    // Resolve names up front; feeds repeat the same district and candidate
+    // names, so reuse the previous lookup when the name has not changed
+    std::vector<VoteStatus> statuses(updates.size(), VoteStatus::Ok);
+    std::vector<std::pair<DistrictHandle, CandidateHandle>> handles(updates.size());
+    const std::string* lastDistrict = nullptr;
+    const std::string* lastCandidate = nullptr;
+    DistrictHandle district = kInvalidHandle;
+    CandidateHandle candidate = kInvalidHandle;
+    for (size_t i = 0; i < updates.size(); ++i) {
+        if (!lastDistrict || updates[i].districtName != *lastDistrict) {
+            district = findDistrict(updates[i].districtName);
+            lastDistrict = &updates[i].districtName;
+        }
+        if (!lastCandidate || updates[i].candidateName != *lastCandidate) {
+            candidate = findCandidate(updates[i].candidateName);
+            lastCandidate = &updates[i].candidateName;
+        }
+        handles[i] = {district, candidate};
+        if (district == kInvalidHandle) {
+            statuses[i] = VoteStatus::UnknownDistrict;
+        } else if (candidate == kInvalidHandle) {
+            statuses[i] = VoteStatus::UnknownCandidate;
+        }
+    }
+    
+    int64_t timestampNs = VoteHistory::nowNanoseconds();
+    
+    std::lock_guard<std::mutex> lock(managerMutex);
+    std::vector<size_t> order;
+    order.reserve(updates.size());
+    for (size_t i = 0; i < updates.size(); ++i) {
+        if (statuses[i] == VoteStatus::Ok) {
+            statuses[i] = voteManager->validateVote(handles[i].first, handles[i].second);
+            if (statuses[i] == VoteStatus::Ok) {
+                order.push_back(i);
+            }
+        }
+    }
+    voteManager->reserveHistory(order.size());
+    
+    // Group the valid updates by district; each group is one tree pass
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return handles[a].first < handles[b].first;
+    });
+    std::vector<PrecinctVote> votes;
+    const std::string* lastPrecinct = nullptr;
+    uint32_t precinct = 0;
+    for (size_t begin = 0; begin < order.size();) {
+        DistrictHandle groupDistrict = handles[order[begin]].first;
+        size_t end = begin;
+        votes.clear();
+        for (; end < order.size() && handles[order[end]].first == groupDistrict; ++end) {
+            const VoteUpdateRequest& update = updates[order[end]];
+            if (!lastPrecinct || update.precinctId != *lastPrecinct) {
+                precinct = voteManager->internPrecinct(update.precinctId);
+                lastPrecinct = &update.precinctId;
+            }
+            votes.push_back({handles[order[end]].second, update.voteCount, precinct});
+        }
         
-        if (districtIt == districts.end()) {
-            return false;
+        // Entries were validated above; applyVotes only repeats the slot
+        // lookup it needs for the tree pass. An I/O error fails this group
+        // alone, the same way the applier thread handles it.
+        VoteStatus status;
+        try {
+            status = voteManager->tryAddVotesBatch(groupDistrict, votes, timestampNs);
+        } catch (const std::exception&) {
+            status = VoteStatus::StorageError;
+        }
+        if (status != VoteStatus::Ok) {
+            for (size_t k = begin; k < end; ++k) {
+                statuses[order[k]] = status;
+            }
+        }
+        begin = end;
+    }
+    return statuses;
+}
+
+VoteStatus ElectionSystem::processPrecinctReport(const std::string& districtName, const std::string& precinctId,
+                                                 const std::vector<std::pair<std::string, int64_t>>& candidateVotes) {
+    if (!isActive) {
+        return VoteStatus::ElectionClosed;
+    }
+    
+    DistrictHandle district = findDistrict(districtName);
+    if (district == kInvalidHandle) {
+        return VoteStatus::UnknownDistrict;
+    }
+    std::vector<std::pair<CandidateHandle, int64_t>> votes;
+    votes.reserve(candidateVotes.size());
+    for (const auto& entry : candidateVotes) {
+        CandidateHandle candidate = findCandidate(entry.first);
+        if (candidate == kInvalidHandle) {
+            return VoteStatus::UnknownCandidate;
+        }
+        votes.emplace_back(candidate, entry.second);
+    }
+    
+    int64_t timestampNs = VoteHistory::nowNanoseconds();
+    
+    std::lock_guard<std::mutex> lock(managerMutex);
+    return voteManager->applyPrecinctReport(district, precinctId, votes, timestampNs);
+}
+
+void ElectionSystem::startIngestion(size_t queueCapacity) {
+    if (applier.joinable()) {
+        throw std::logic_error("Ingestion is already running");
+    }
+    
+    // No thread can be using the old queue: the last stop waited them out,
+    // and new users only touch the queue after seeing applierRunning
+    ingestQueue = std::make_unique<MpscQueue<PendingVoteUpdate>>(queueCapacity);
+    applierRunning.store(true, std::memory_order_seq_cst);
+    applier = std::thread(&ElectionSystem::applyLoop, this);
+}
+
+bool ElectionSystem::enterQueue() const {
+    // seq_cst pairs with stopIngestion: either this sees the stop, or the
+    // applier sees this user and waits for it before its final drain
+    queueUsers.fetch_add(1, std::memory_order_seq_cst);
+    if (!applierRunning.load(std::memory_order_seq_cst)) {
+        queueUsers.fetch_sub(1, std::memory_order_release);
+        return false;
+    }
+    return true;
+}
+
+void ElectionSystem::notifyProgress() {
+    // Taking the lock orders the counter updates before a waiter's predicate check
+    { std::lock_guard<std::mutex> lock(progressMutex); }
+    progressMade.notify_all();
+}
+
+bool ElectionSystem::submitVoteUpdate(const std::string& districtName,
+                                      const std::string& candidateName,
+                                      int64_t voteCount,
+                                      const std::string& precinctId) {
+    if (!isActive) {
+        return false;
+    }
+    
+    // Name lookups are read-only after setup, so producers resolve them here
+    DistrictHandle district = findDistrict(districtName);
+    CandidateHandle candidate = findCandidate(candidateName);
+    if (district == kInvalidHandle || candidate == kInvalidHandle) {
+        return false;
+    }
+    
+    if (!enterQueue()) {
+        return false;
+    }
+    attemptedCount.fetch_add(1, std::memory_order_relaxed);
+    PendingVoteUpdate update{district, candidate, voteCount, precinctId, std::chrono::steady_clock::now()};
+    bool pushed = ingestQueue->tryPush(std::move(update));
+    if (pushed) {
+        submittedCount.fetch_add(1, std::memory_order_release);
+    } else {
+        droppedCount.fetch_add(1, std::memory_order_release);
+    }
+    queueUsers.fetch_sub(1, std::memory_order_release);
+    if (!pushed) {
+        notifyProgress();
+    }
+    return pushed;
+}
+
+void ElectionSystem::applyLoop() {
+    std::vector<PendingVoteUpdate> batch;
+    batch.reserve(kMaxDrainBatch);
+    PendingVoteUpdate update;
+    
+    for (;;) {
+        // After a stop, wait out producers that passed the running check;
+        // once they are gone nothing more can enter the queue
+        bool stopping = !applierRunning.load(std::memory_order_seq_cst);
+        if (stopping) {
+            while (queueUsers.load(std::memory_order_acquire) != 0) {
+                std::this_thread::yield();
+            }
         }
         
-        // Find candidate by name
-        auto candidates = voteManager->getCandidates();
-        auto candidateIt = std::find_if(candidates.begin(), candidates.end(),
-            [&candidateName](const Candidate& c) { return c.name == candidateName; });
+        size_t depth = ingestQueue->sizeApprox();
+        if (depth > maxQueueDepth.load(std::memory_order_relaxed)) {
+            maxQueueDepth.store(depth, std::memory_order_relaxed);
+        }
         
-        if (candidateIt == candidates.end()) {
-            return false;
+        while (batch.size() < kMaxDrainBatch && ingestQueue->tryPop(update)) {
+            batch.push_back(std::move(update));
+        }
+        if (!batch.empty()) {
+            applyBatch(batch);
+            batch.clear();
+            notifyProgress();
+            continue;
         }
         
-        // Generate timestamp
-        auto now = std::chrono::system_clock::now();
-        auto time_t = std::chrono::system_clock::to_time_t(now);
-        std::string timestamp = std::ctime(&time_t);
-        timestamp.pop_back(); // Remove newline
+        // Final drain done: the queue is empty and has no producers left
+        if (stopping) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+}
+
+void ElectionSystem::applyBatch(std::vector<PendingVoteUpdate>& batch) {
+    auto oldest = batch.front().enqueued;
+    for (const auto& update : batch) {
+        oldest = std::min(oldest, update.enqueued);
+    }
+    
+    // Sort by district, then precinct, so each district is one tree pass
+    // and each precinct is interned once
+    std::stable_sort(batch.begin(), batch.end(), [](const auto& a, const auto& b) {
+        return a.district != b.district ? a.district < b.district : a.precinctId < b.precinctId;
+    });
+    
+    uint64_t failed = 0;
+    std::vector<PrecinctVote> votes;
+    {
+        std::lock_guard<std::mutex> lock(managerMutex);
         
-        // Process the vote update
-        voteManager->addVotes(districtIt->id, candidateIt->id, voteCount, precinctId, timestamp);
-        return true;
+        // One clock read for the whole batch
+        int64_t timestampNs = VoteHistory::nowNanoseconds();
         
-    } catch (const std::exception& e) {
-        return false;
+        const std::string* lastPrecinct = nullptr;
+        uint32_t precinct = 0;
+        for (size_t begin = 0; begin < batch.size();) {
+            DistrictHandle district = batch[begin].district;
+            size_t end = begin;
+            votes.clear();
+            
+            // A rejected update fails alone, as it would through processVoteUpdate
+            for (; end < batch.size() && batch[end].district == district; ++end) {
+                const PendingVoteUpdate& update = batch[end];
+                if (voteManager->validateVote(district, update.candidate) != VoteStatus::Ok) {
+                    ++failed;
+                    continue;
+                }
+                if (!lastPrecinct || update.precinctId != *lastPrecinct) {
+                    precinct = voteManager->internPrecinct(update.precinctId);
+                    lastPrecinct = &update.precinctId;
+                }
+                votes.push_back({update.candidate, update.voteCount, precinct});
+            }
+            
+            // Only log or tally file I/O errors are left, and those must not
+            // escape the applier thread
+            if (!votes.empty()) {
+                bool applied;
+                try {
+                    applied = voteManager->tryAddVotesBatch(district, votes, timestampNs) == VoteStatus::Ok;
+                } catch (const std::exception&) {
+                    applied = false;
+                }
+                if (!applied) {
+                    failed += votes.size();
+                }
+            }
+            begin = end;
+        }
+    }
+    
+    uint64_t latency = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - oldest).count());
+    lastDrainLatencyNs.store(latency, std::memory_order_relaxed);
+    if (latency > maxDrainLatencyNs.load(std::memory_order_relaxed)) {
+        maxDrainLatencyNs.store(latency, std::memory_order_relaxed);
+    }
+    batchCount.fetch_add(1, std::memory_order_relaxed);
+    failedCount.fetch_add(failed, std::memory_order_release);
+    appliedCount.fetch_add(batch.size() - failed, std::memory_order_release);
+}
+
+void ElectionSystem::flushIngestion() {
+    if (!applier.joinable()) {
+        return;
     }
+    
+    // Every attempt counted here ends up applied, failed or dropped
+    uint64_t target = attemptedCount.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(progressMutex);
+    progressMade.wait(lock, [&]() {
+        return appliedCount.load(std::memory_order_acquire) + failedCount.load(std::memory_order_acquire) +
+               droppedCount.load(std::memory_order_acquire) >= target;
+    });
+}
+
+void ElectionSystem::stopIngestion() {
+    if (!applier.joinable()) {
+        return;
+    }
+    
+    applierRunning.store(false, std::memory_order_seq_cst);
+    applier.join();
+}
+
+IngestionStats ElectionSystem::getIngestionStats() const {
+    IngestionStats stats;
+    stats.submitted = submittedCount.load(std::memory_order_relaxed);
+    stats.dropped = droppedCount.load(std::memory_order_relaxed);
+    stats.applied = appliedCount.load(std::memory_order_relaxed);
+    stats.failed = failedCount.load(std::memory_order_relaxed);
+    stats.batches = batchCount.load(std::memory_order_relaxed);
+    if (enterQueue()) {
+        stats.queueDepth = ingestQueue->sizeApprox();
+        queueUsers.fetch_sub(1, std::memory_order_release);
+    }
+    stats.maxQueueDepth = maxQueueDepth.load(std::memory_order_relaxed);
+    stats.lastDrainLatencyNs = lastDrainLatencyNs.load(std::memory_order_relaxed);
+    stats.maxDrainLatencyNs = maxDrainLatencyNs.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::shared_ptr<const VoteSnapshot> ElectionSystem::getSnapshot() const {
+    // Hold the lock only to publish the rows changed since the last report
+    std::lock_guard<std::mutex> lock(managerMutex);
+    return voteManager->publishSnapshot();
 }
 
     string ElectionSystem::getCurrentResults() const {
-    return voteManager->getDetailedResults();
+    auto view = getSnapshot();
+    return voteManager->getDetailedResults(*view);
 }
 
     string ElectionSystem::getDistrictResults(const std::string& districtName) const {
-    auto districts = voteManager->getDistricts();
-    auto districtIt = std::find_if(districts.begin(), districts.end(),
-        [&districtName](const District& d) { return d.name == districtName; });
-    
-    if (districtIt == districts.end()) {
+    DistrictHandle district = findDistrict(districtName);
+    if (district == kInvalidHandle) {
         return "District not found: " + districtName;
     }
     
+    auto view = getSnapshot();
+    
     std::ostringstream oss;
     oss << "=== DISTRICT RESULTS: " << districtName << " ===\n\n";
     
-    auto candidates = voteManager->getCandidates();
-    std::vector<std::pair<std::string, int64_t>> districtResults;
+    const auto& candidates = voteManager->getCandidates();
+    std::vector<std::pair<CandidateHandle, int64_t>> districtResults;
     
-    for (const auto& candidate : candidates) {
-        int64_t votes = voteManager->getCandidateVotes(districtIt->id, candidate.id);
-        if (votes > 0) {
-            districtResults.emplace_back(candidate.id, votes);
+    const std::vector<int64_t>& votes = view->getDistrictVotes(district);
+    for (CandidateHandle candidate = 0; candidate < votes.size(); ++candidate) {
+        if (votes[candidate] > 0) {
+            districtResults.emplace_back(candidate, votes[candidate]);
         }
     }
     
@@ -115,39 +447,36 @@ bool ElectionSystem::processVoteUpdate(const std::string& districtName,
         [](const auto& a, const auto& b) { return a.second > b.second; });
     
     for (const auto& result : districtResults) {
-        auto candidateIt = std::find_if(candidates.begin(), candidates.end(),
-            [&result](const Candidate& c) { return c.id == result.first; });
-        if (candidateIt != candidates.end()) {
-            oss << std::setw(20) << std::left << candidateIt->name
-                << " (" << candidateIt->party << "): " << result.second << " votes\n";
-        }
+        const auto& candidate = candidates[result.first];
+        oss << std::setw(20) << std::left << candidate.name
+            << " (" << candidate.party << "): " << result.second << " votes\n";
     }
     
-    int64_t districtTotal = voteManager->getDistrictTotalVotes(districtIt->id);
+    int64_t districtTotal = view->getDistrictTotalVotes(district);
     oss << "\nTOTAL DISTRICT VOTES: " << districtTotal << "\n";
     
     return oss.str();
 }
 
     string ElectionSystem::getCandidateResults(const std::string& candidateName) const {
-    auto candidates = voteManager->getCandidates();
-    auto candidateIt = std::find_if(candidates.begin(), candidates.end(),
-        [&candidateName](const Candidate& c) { return c.name == candidateName; });
-    
-    if (candidateIt == candidates.end()) {
+    CandidateHandle candidate = findCandidate(candidateName);
+    if (candidate == kInvalidHandle) {
         return "Candidate not found: " + candidateName;
     }
     
+    auto view = getSnapshot();
+    
     std::ostringstream oss;
-    oss << "=== CANDIDATE RESULTS: " << candidateName << " (" << candidateIt->party << ") ===\n\n";
+    oss << "=== CANDIDATE RESULTS: " << candidateName << " ("
+        << voteManager->getCandidates()[candidate].party << ") ===\n\n";
     
-    auto districts = voteManager->getDistricts();
+    const auto& districts = voteManager->getDistricts();
     int64_t totalVotes = 0;
     
-    for (const auto& district : districts) {
-        int64_t votes = voteManager->getCandidateVotes(district.id, candidateIt->id);
+    for (DistrictHandle district = 0; district < districts.size(); ++district) {
+        int64_t votes = view->getCandidateVotes(district, candidate);
         if (votes > 0) {
-            oss << std::setw(20) << std::left << district.name << ": " << votes << " votes\n";
+            oss << std::setw(20) << std::left << districts[district].name << ": " << votes << " votes\n";
             totalVotes += votes;
         }
     }
@@ -158,32 +487,34 @@ bool ElectionSystem::processVoteUpdate(const std::string& districtName,
 }
 
     string ElectionSystem::getCurrentLeader() const {
-        string leaderId = voteManager->getOverallLeader();
-    if (leaderId.empty()) {
+    auto view = getSnapshot();
+    CandidateHandle leader = view->getOverallLeader();
+    if (leader == kInvalidHandle) {
         return "No votes cast yet";
     }
     
-    auto candidates = voteManager->getCandidates();
-    auto leaderIt = std::find_if(candidates.begin(), candidates.end(),
-        [&leaderId](const Candidate& c) { return c.id == leaderId; });
-    
-    if (leaderIt != candidates.end()) {
-        int64_t totalVotes = voteManager->getCandidateTotalVotes(leaderId);
-        return leaderIt->name + " (" + leaderIt->party + ") - " + std::to_string(totalVotes) + " votes";
+    if (leader < voteManager->getCandidates().size()) {
+        const auto& candidate = voteManager->getCandidates()[leader];
+        int64_t totalVotes = view->getCandidateTotalVotes(leader);
+        return candidate.name + " (" + candidate.party + ") - " + std::to_string(totalVotes) + " votes";
     }
     
     return "Unknown leader";
 }
 
     vector<VoteUpdate> ElectionSystem::getVoteHistory() const {
-    return voteManager->getVoteHistory();
+    std::lock_guard<std::mutex> lock(managerMutex);
+    VoteHistoryView history = voteManager->getVoteHistory();
+    return std::vector<VoteUpdate>(history.begin(), history.end());
 }
 
 void ElectionSystem::resetElection() {
+    std::lock_guard<std::mutex> lock(managerMutex);
     voteManager->resetVotes();
 }
 
     string ElectionSystem::getElectionInfo() const {
+    std::lock_guard<std::mutex> lock(managerMutex);
         ostringstream oss;
     oss << "=== ELECTION INFORMATION ===\n";
     oss << "Name: " << electionName << "\n";
@@ -201,8 +532,8 @@ void ElectionSystem::simulateRandomUpdates(int numUpdates) {
         return;
     }
     
-    auto districts = voteManager->getDistricts();
-    auto candidates = voteManager->getCandidates();
+    const auto& districts = voteManager->getDistricts();
+    const auto& candidates = voteManager->getCandidates();
     
     if (districts.empty() || candidates.empty()) {
         return;
@@ -215,12 +546,15 @@ void ElectionSystem::simulateRandomUpdates(int numUpdates) {
         uniform_int_distribution<> voteDist(1, 100);
         uniform_int_distribution<> precinctDist(1, 999);
     
+    std::vector<VoteUpdateRequest> updates;
+    updates.reserve(numUpdates > 0 ? numUpdates : 0);
     for (int i = 0; i < numUpdates; ++i) {
         const auto& district = districts[districtDist(gen)];
         const auto& candidate = candidates[candidateDist(gen)];
         int64_t voteCount = voteDist(gen);
             string precinctId = "P" + std::to_string(precinctDist(gen));
         
-        processVoteUpdate(district.name, candidate.name, voteCount, precinctId);
+        updates.push_back({district.name, candidate.name, voteCount, precinctId});
     }
+    processVoteUpdates(updates);
 }
@@ -0,0 +1,68 @@
+#include "leader_tracker.hpp"
+#include <stdexcept>
+#include <algorithm>
+using namespace std;
+
+LeaderTracker::LeaderTracker(size_t n) {
+    count = n;
+    size_t newCapacity = 1;
+    while (newCapacity < n) {
+        newCapacity *= 2;
+    }
+    rebuild(newCapacity);
+}
+
+void LeaderTracker::rebuild(size_t newCapacity) {
+    values.resize(newCapacity, kInactive);
+    winners.assign(2 * newCapacity, 0);
+    capacity = newCapacity;
+
+    for (size_t i = 0; i < capacity; ++i) {
+        winners[capacity + i] = static_cast<uint32_t>(i);
+    }
+    for (size_t node = capacity - 1; node >= 1; --node) {
+        winners[node] = play(winners[2 * node], winners[2 * node + 1]);
+    }
+}
+
+void LeaderTracker::replay(size_t i) {
+    for (size_t node = (capacity + i) / 2; node >= 1; node /= 2) {
+        winners[node] = play(winners[2 * node], winners[2 * node + 1]);
+    }
+}
+
+void LeaderTracker::append(int64_t value) {
+    if (count == capacity) {
+        rebuild(capacity * 2);
+    }
+    values[count] = value;
+    replay(count);
+    ++count;
+}
+
+void LeaderTracker::activate(size_t i) {
+    if (i >= count) {
+        throw std::out_of_range("Index out of range for LeaderTracker activate");
+    }
+    if (values[i] == kInactive) {
+        values[i] = 0;
+        replay(i);
+    }
+}
+
+void LeaderTracker::add(size_t i, int64_t delta) {
+    if (i >= count || values[i] == kInactive) {
+        throw std::out_of_range("Index out of range for LeaderTracker add");
+    }
+    values[i] += delta;
+    replay(i);
+}
+
+void LeaderTracker::reset() {
+    for (auto& v : values) {
+        if (v != kInactive) {
+            v = 0;
+        }
+    }
+    rebuild(capacity);
+}
@@ -0,0 +1,306 @@
+#include "mapped_tally_store.hpp"
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+using namespace std;
+
+namespace {
+
+constexpr uint64_t kTallyMagic = 0x31594C4C41544356;  // "VCTALLY1"
+constexpr uint64_t kTallyFormat = 1;
+constexpr uint64_t kHeaderWords = 8;
+constexpr size_t kMinFileBytes = 1 << 16;
+
+size_t lsb(size_t x) {
+    return x & (~x + 1);
+}
+
+// Keep the compiler from reordering stores to the mapping across this
+// point. The CPU already makes them visible in order to the page cache,
+// which is all a killed process leaves behind.
+void orderStores() {
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+} // namespace
+
+MappedTallyStore::MappedTallyStore(const std::string& path, MappedTallyOptions options)
+    : path(path), options(options), recordsEnd(kHeaderWords) {
+    size_t existing = file.open(path, kMinFileBytes);
+    Header* h = header();
+    if (existing == 0) {
+        h->magic = kTallyMagic;
+        h->format = kTallyFormat;
+        return;
+    }
+    if (existing < sizeof(Header) || h->magic != kTallyMagic) {
+        throw std::runtime_error("Not a tally file: " + path);
+    }
+    if (h->format != kTallyFormat) {
+        throw std::runtime_error("Unsupported tally file format: " + path);
+    }
+
+    // Index the complete records; anything past them is journal space
+    uint64_t totalWords = file.size() / sizeof(int64_t);
+    for (uint64_t d = 0; d < h->districtCount; ++d) {
+        if (recordsEnd >= totalWords ||
+            static_cast<uint64_t>(words()[recordsEnd]) >= totalWords - recordsEnd) {
+            throw std::runtime_error("Truncated tally file: " + path);
+        }
+        uint64_t n = static_cast<uint64_t>(words()[recordsEnd]);
+        rowOffsets.push_back(recordsEnd + 1);
+        slotCounts.push_back(static_cast<size_t>(n));
+        widestRow = std::max(widestRow, static_cast<size_t>(n));
+        recordsEnd += 1 + n;
+    }
+
+    recover();
+}
+
+void MappedTallyStore::recover() {
+    Header* h = header();
+    switch (static_cast<JournalState>(h->journalState)) {
+        case JournalState::Undo: {
+            // Restore in reverse so the oldest value wins for any repeated word
+            const JournalEntry* entries = journal();
+            for (uint64_t i = h->journalEntries; i-- > 0;) {
+                if (entries[i].word >= recordsEnd) {
+                    throw std::runtime_error("Corrupt tally journal: " + path);
+                }
+                words()[entries[i].word] = entries[i].oldValue;
+            }
+            h->commitCount = h->journalBase;
+            break;
+        }
+        case JournalState::Reset:
+            // Zeroing is idempotent, so an interrupted reset is finished
+            for (size_t d = 0; d < rowOffsets.size(); ++d) {
+                std::fill_n(words() + rowOffsets[d], slotCounts[d], 0);
+            }
+            h->commitCount = h->journalBase + 1;
+            break;
+        case JournalState::Idle:
+            return;
+        default:
+            throw std::runtime_error("Corrupt tally journal: " + path);
+    }
+    orderStores();
+    h->journalState = static_cast<uint64_t>(JournalState::Idle);
+    if (options.syncPolicy != MsyncPolicy::None) {
+        sync();
+    }
+}
+
+void MappedTallyStore::reserveWords(uint64_t recordWords, size_t journalCapacity) {
+    size_t needed = static_cast<size_t>(recordWords) * sizeof(int64_t) + journalCapacity * sizeof(JournalEntry);
+    if (needed > file.size()) {
+        file.resize(std::max(needed, file.size() * 2));
+    }
+}
+
+void MappedTallyStore::beginChange(size_t entryCount) {
+    Header* h = header();
+    if (options.syncPolicy == MsyncPolicy::EveryCommit) {
+        syncRange(recordsEnd * sizeof(int64_t), entryCount * sizeof(JournalEntry));
+    }
+    h->journalEntries = entryCount;
+    h->journalBase = h->commitCount;
+    orderStores();
+    h->journalState = static_cast<uint64_t>(JournalState::Undo);
+    orderStores();
+    if (options.syncPolicy == MsyncPolicy::EveryCommit) {
+        syncRange(0, sizeof(Header));
+    }
+}
+
+void MappedTallyStore::commitChange(uint64_t firstWord, uint64_t wordCount) {
+    Header* h = header();
+    orderStores();
+    if (options.syncPolicy == MsyncPolicy::EveryCommit) {
+        syncRange(firstWord * sizeof(int64_t), wordCount * sizeof(int64_t));
+    }
+    h->commitCount = h->journalBase + 1;
+    orderStores();
+    h->journalState = static_cast<uint64_t>(JournalState::Idle);
+
+    if (options.syncPolicy == MsyncPolicy::EveryCommit) {
+        syncRange(0, sizeof(Header));
+    } else if (options.syncPolicy == MsyncPolicy::Interval &&
+               options.syncInterval > 0 && h->commitCount % options.syncInterval == 0) {
+        sync();
+    }
+}
+
+void MappedTallyStore::addDistrict(size_t candidateCount) {
+    if (attachedCount < rowOffsets.size()) {
+        if (slotCounts[attachedCount] != candidateCount) {
+            throw std::runtime_error("Tally file district " + std::to_string(attachedCount) + " has " +
+                                     std::to_string(slotCounts[attachedCount]) + " slots, expected " +
+                                     std::to_string(candidateCount));
+        }
+        ++attachedCount;
+        return;
+    }
+
+    // Write the record where the journal was, then publish it by bumping
+    // the count; a crash before that leaves it as unused scratch space
+    size_t widest = std::max(widestRow, candidateCount);
+    reserveWords(recordsEnd + 1 + candidateCount, widest);
+    int64_t* record = words() + recordsEnd;
+    record[0] = static_cast<int64_t>(candidateCount);
+    std::fill_n(record + 1, candidateCount, 0);
+    orderStores();
+    if (options.syncPolicy == MsyncPolicy::EveryCommit) {
+        syncRange(recordsEnd * sizeof(int64_t), (1 + candidateCount) * sizeof(int64_t));
+    }
+    header()->districtCount += 1;
+    if (options.syncPolicy == MsyncPolicy::EveryCommit) {
+        syncRange(0, sizeof(Header));
+    }
+
+    rowOffsets.push_back(recordsEnd + 1);
+    slotCounts.push_back(candidateCount);
+    recordsEnd += 1 + candidateCount;
+    widestRow = widest;
+    ++attachedCount;
+}
+
+void MappedTallyStore::update(size_t district, size_t slot, int64_t delta) {
+    size_t n = slotCounts[district];
+    if (slot == 0 || slot > n) {
+        throw std::out_of_range("Index out of range for mapped tally update");
+    }
+
+    // Nodes are 1-based: row[slot]
+    uint64_t first = rowOffsets[district];
+    int64_t* row = words() + first - 1;
+    JournalEntry* entries = journal();
+    size_t count = 0;
+    for (size_t i = slot; i <= n; i += lsb(i)) {
+        entries[count++] = {first + i - 1, row[i]};
+    }
+    beginChange(count);
+
+    for (size_t i = slot; i <= n; i += lsb(i)) {
+        row[i] += delta;
+    }
+    commitChange(first, n);
+}
+
+void MappedTallyStore::applyDenseBatch(size_t district, const std::vector<int64_t>& slotDeltas) {
+    size_t n = slotCounts[district];
+    if (slotDeltas.size() > n) {
+        throw std::out_of_range("Too many deltas for mapped tally applyDenseBatch");
+    }
+
+    uint64_t first = rowOffsets[district];
+    int64_t* row = words() + first - 1;
+    JournalEntry* entries = journal();
+    for (size_t i = 1; i <= n; ++i) {
+        entries[i - 1] = {first + i - 1, row[i]};
+    }
+    beginChange(n);
+
+    // Same single-pass carry as FenwickTree::applyDenseBatch
+    std::vector<int64_t> carry(slotDeltas.begin(), slotDeltas.end());
+    carry.resize(n, 0);
+    for (size_t slot = 1; slot <= n; ++slot) {
+        row[slot] += carry[slot - 1];
+        size_t parent = slot + lsb(slot);
+        if (parent <= n) {
+            carry[parent - 1] += carry[slot - 1];
+        }
+    }
+    commitChange(first, n);
+}
+
+int64_t MappedTallyStore::prefix(size_t district, size_t slot) const {
+    const int64_t* row = words() + rowOffsets[district] - 1;
+    int64_t sum = 0;
+    while (slot > 0) {
+        sum += row[slot];
+        slot -= lsb(slot);
+    }
+    return sum;
+}
+
+int64_t MappedTallyStore::getValue(size_t district, size_t slot) const {
+    if (slot == 0 || slot > slotCounts[district]) {
+        throw std::out_of_range("Index out of range for mapped tally getValue");
+    }
+    return prefix(district, slot) - prefix(district, slot - 1);
+}
+
+int64_t MappedTallyStore::getDistrictTotal(size_t district) const {
+    return prefix(district, slotCounts[district]);
+}
+
+void MappedTallyStore::readDistrict(size_t district, std::vector<int64_t>& out) const {
+    size_t n = slotCounts[district];
+    const int64_t* row = words() + rowOffsets[district];
+    out.assign(row, row + n);
+
+    // Undo the Fenwick accumulation, as in MatrixTallyStore::readDistrict
+    for (size_t slot = n; slot >= 1; --slot) {
+        size_t parent = slot + lsb(slot);
+        if (parent <= n) {
+            out[parent - 1] -= out[slot - 1];
+        }
+    }
+}
+
+void MappedTallyStore::loadDistrict(size_t district, const std::vector<int64_t>& values) {
+    size_t n = slotCounts[district];
+    if (values.size() != n) {
+        throw std::invalid_argument("Value count does not match district size");
+    }
+
+    uint64_t first = rowOffsets[district];
+    int64_t* row = words() + first - 1;
+    JournalEntry* entries = journal();
+    for (size_t i = 1; i <= n; ++i) {
+        entries[i - 1] = {first + i - 1, row[i]};
+    }
+    beginChange(n);
+
+    for (size_t slot = 1; slot <= n; ++slot) {
+        row[slot] = values[slot - 1];
+    }
+    for (size_t slot = 1; slot <= n; ++slot) {
+        size_t parent = slot + lsb(slot);
+        if (parent <= n) {
+            row[parent] += row[slot];
+        }
+    }
+    commitChange(first, n);
+}
+
+size_t MappedTallyStore::getSlotCount(size_t district) const {
+    return slotCounts[district];
+}
+
+void MappedTallyStore::reset() {
+    Header* h = header();
+    h->journalBase = h->commitCount;
+    orderStores();
+    h->journalState = static_cast<uint64_t>(JournalState::Reset);
+    orderStores();
+    if (options.syncPolicy == MsyncPolicy::EveryCommit) {
+        syncRange(0, sizeof(Header));
+    }
+
+    for (size_t d = 0; d < rowOffsets.size(); ++d) {
+        std::fill_n(words() + rowOffsets[d], slotCounts[d], 0);
+    }
+    commitChange(kHeaderWords, recordsEnd - kHeaderWords);
+}
+
+void MappedTallyStore::sync() {
+    syncRange(0, file.size());
+}
+
+void MappedTallyStore::syncRange(size_t offset, size_t length) {
+    if (!file.sync(offset, length)) {
+        throw std::runtime_error("Cannot sync tally file: " + path);
+    }
+}
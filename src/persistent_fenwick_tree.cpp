@@ -0,0 +1,120 @@
+#include "persistent_fenwick_tree.hpp"
+#include <algorithm>
+#include <stdexcept>
+using namespace std;
+
+PersistentFenwickTree::PersistentFenwickTree(size_t n) : nodes(n + 1), size(n) {
+    if (n == 0) {
+        throw std::invalid_argument("Fenwick Tree size must be greater than 0");
+    }
+}
+
+int64_t PersistentFenwickTree::nodeAt(size_t node, uint64_t version) const {
+    const auto& entries = nodes[node];
+    // First entry newer than the version; the one before it is the answer
+    auto it = std::upper_bound(entries.begin(), entries.end(), version,
+        [](uint64_t v, const Entry& entry) { return v < entry.first; });
+    return it == entries.begin() ? 0 : std::prev(it)->second;
+}
+
+void PersistentFenwickTree::record(size_t node, uint64_t version, int64_t value) {
+    auto& entries = nodes[node];
+    if (!entries.empty() && entries.back().first == version) {
+        entries.back().second = value;
+    } else {
+        entries.emplace_back(version, value);
+    }
+}
+
+void PersistentFenwickTree::update(size_t i, int64_t delta, uint64_t version) {
+    if (i == 0 || i > size) {
+        throw std::out_of_range("Index out of range for Fenwick Tree update");
+    }
+    if (version < latestVersion) {
+        throw std::invalid_argument("Fenwick Tree versions must not go backwards");
+    }
+
+    latestVersion = version;
+    for (; i <= size; i += lsb(i)) {
+        int64_t current = nodes[i].empty() ? 0 : nodes[i].back().second;
+        record(i, version, current + delta);
+    }
+}
+
+int64_t PersistentFenwickTree::queryAt(size_t i, uint64_t version) const {
+    if (i > size) {
+        throw std::out_of_range("Index out of range for Fenwick Tree query");
+    }
+    if (version < oldestVersion) {
+        throw std::out_of_range("Version was compacted away");
+    }
+
+    int64_t sum = 0;
+    for (; i > 0; i -= lsb(i)) {
+        sum += nodeAt(i, version);
+    }
+    return sum;
+}
+
+int64_t PersistentFenwickTree::rangeQueryAt(size_t left, size_t right, uint64_t version) const {
+    if (left > right) {
+        throw std::invalid_argument("Left boundary must be <= right boundary");
+    }
+    if (left == 0 || right > size) {
+        throw std::out_of_range("Range boundaries out of range for Fenwick Tree");
+    }
+    return queryAt(right, version) - queryAt(left - 1, version);
+}
+
+int64_t PersistentFenwickTree::getValueAt(size_t i, uint64_t version) const {
+    if (i == 0 || i > size) {
+        throw std::out_of_range("Index out of range for Fenwick Tree getValue");
+    }
+    return rangeQueryAt(i, i, version);
+}
+
+void PersistentFenwickTree::reset(uint64_t version) {
+    if (version < latestVersion) {
+        throw std::invalid_argument("Fenwick Tree versions must not go backwards");
+    }
+
+    latestVersion = version;
+    for (size_t i = 1; i <= size; ++i) {
+        if (!nodes[i].empty() && nodes[i].back().second != 0) {
+            record(i, version, 0);
+        }
+    }
+}
+
+void PersistentFenwickTree::compact(uint64_t checkpoint) {
+    if (checkpoint <= oldestVersion) {
+        return;
+    }
+    // Values are unchanged past the newest write, so a later checkpoint is fine
+    latestVersion = std::max(latestVersion, checkpoint);
+
+    for (size_t i = 1; i <= size; ++i) {
+        auto& entries = nodes[i];
+        auto first = std::upper_bound(entries.begin(), entries.end(), checkpoint,
+            [](uint64_t v, const Entry& entry) { return v < entry.first; });
+        if (first == entries.begin()) {
+            continue;
+        }
+
+        // Keep the entry in force at the checkpoint, re-stamped as the base
+        auto base = std::prev(first);
+        Entry folded(checkpoint, base->second);
+        entries.erase(entries.begin(), base);
+        entries.front() = folded;
+        entries.shrink_to_fit();
+    }
+    oldestVersion = checkpoint;
+}
+
+size_t PersistentFenwickTree::getEntryCount() const {
+    size_t count = 0;
+    for (const auto& entries : nodes) {
+        count += entries.size();
+    }
+    return count;
+}
@@ -0,0 +1,70 @@
+#include "precinct_index.hpp"
+#include <algorithm>
+#include <stdexcept>
+using namespace std;
+
+namespace {
+
+uint64_t districtKey(uint32_t district, uint32_t precinctId) {
+    return (static_cast<uint64_t>(district) << 32) | precinctId;
+}
+
+} // namespace
+
+void PrecinctIndex::addDistrict(size_t slotCount) {
+    districts.emplace_back();
+    districts.back().slotCount = slotCount;
+}
+
+PrecinctHandle PrecinctIndex::find(uint32_t district, uint32_t precinctId) const {
+    if (precinctId >= firstById.size() || firstById[precinctId] == npos) {
+        return npos;
+    }
+    PrecinctHandle first = firstById[precinctId];
+    if (entries[first].district == district) {
+        return first;
+    }
+    auto it = otherDistricts.find(districtKey(district, precinctId));
+    return it == otherDistricts.end() ? npos : it->second;
+}
+
+PrecinctHandle PrecinctIndex::addPrecinct(uint32_t district, uint32_t precinctId) {
+    if (district >= districts.size()) {
+        throw std::out_of_range("Invalid district handle");
+    }
+    PrecinctHandle existing = find(district, precinctId);
+    if (existing != npos) {
+        return existing;
+    }
+
+    PrecinctHandle handle = static_cast<PrecinctHandle>(entries.size());
+    DistrictState& state = districts[district];
+    uint32_t local = static_cast<uint32_t>(state.precincts.size());
+    entries.push_back({district, precinctId, local, counters.size(), 0});
+    counters.resize(counters.size() + state.slotCount, 0);
+    state.precincts.push_back(handle);
+    if (local / 64 >= state.reportedBits.size()) {
+        state.reportedBits.push_back(0);
+    }
+
+    if (precinctId >= firstById.size()) {
+        firstById.resize(precinctId + 1, npos);
+    }
+    if (firstById[precinctId] == npos) {
+        firstById[precinctId] = handle;
+    } else {
+        otherDistricts.emplace(districtKey(district, precinctId), handle);
+    }
+    return handle;
+}
+
+void PrecinctIndex::reset() {
+    std::fill(counters.begin(), counters.end(), 0);
+    for (Entry& entry : entries) {
+        entry.total = 0;
+    }
+    for (DistrictState& state : districts) {
+        std::fill(state.reportedBits.begin(), state.reportedBits.end(), 0);
+        state.reportedCount = 0;
+    }
+}
@@ -0,0 +1,81 @@
+#include "sharded_tally.hpp"
+#include <stdexcept>
+using namespace std;
+
+ShardedTally::ShardedTally(const std::vector<size_t>& slotCounts, size_t shardCount)
+    : slotCounts(slotCounts), shardCount(shardCount) {
+    if (shardCount == 0) {
+        throw invalid_argument("ShardedTally needs at least one shard");
+    }
+
+    size_t total = 0;
+    for (size_t count : slotCounts) {
+        rowOffsets.push_back(total);
+        total += count;
+    }
+    lineCount = (total + kLineWords - 1) / kLineWords;
+
+    shards.reset(new Shard[shardCount]);
+    for (size_t s = 0; s < shardCount; ++s) {
+        shards[s].lines.reset(new Line[lineCount == 0 ? 1 : lineCount]);
+    }
+    reset();
+}
+
+void ShardedTally::add(size_t shard, size_t district, size_t slot, int64_t delta) {
+    if (shard >= shardCount) {
+        throw std::out_of_range("Shard index out of range");
+    }
+    if (slot == 0 || slot > slotCounts[district]) {
+        throw std::out_of_range("Index out of range for sharded tally");
+    }
+
+    // Single writer per shard: a plain load + store is enough, no RMW needed
+    Shard& owned = shards[shard];
+    auto& cell = counter(owned, rowOffsets[district] + slot - 1);
+    cell.store(cell.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    owned.version.store(owned.version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+int64_t ShardedTally::getValue(size_t district, size_t slot) const {
+    if (slot == 0 || slot > slotCounts[district]) {
+        throw std::out_of_range("Index out of range for sharded tally");
+    }
+
+    size_t index = rowOffsets[district] + slot - 1;
+    int64_t sum = 0;
+    for (size_t s = 0; s < shardCount; ++s) {
+        sum += counter(shards[s], index).load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+void ShardedTally::accumulateDistrict(size_t district, std::vector<int64_t>& out) const {
+    size_t first = rowOffsets[district];
+    size_t n = slotCounts[district];
+    for (size_t s = 0; s < shardCount; ++s) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] += counter(shards[s], first + i).load(std::memory_order_relaxed);
+        }
+    }
+}
+
+uint64_t ShardedTally::epoch() const {
+    uint64_t sum = 0;
+    for (size_t s = 0; s < shardCount; ++s) {
+        sum += shards[s].version.load(std::memory_order_acquire);
+    }
+    return sum;
+}
+
+void ShardedTally::reset() {
+    for (size_t s = 0; s < shardCount; ++s) {
+        for (size_t line = 0; line < (lineCount == 0 ? 1 : lineCount); ++line) {
+            for (auto& word : shards[s].lines[line].words) {
+                word.store(0, std::memory_order_relaxed);
+            }
+        }
+        // Bump rather than clear the version so cached merges are invalidated
+        shards[s].version.fetch_add(1, std::memory_order_release);
+    }
+}
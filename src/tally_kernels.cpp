@@ -0,0 +1,100 @@
+#include "tally_kernels.hpp"
+#include <limits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+int64_t sumCounters(const int64_t* values, size_t n) {
+    size_t i = 0;
+    int64_t sum = 0;
+
+#if defined(__AVX2__)
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm256_add_epi64(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)));
+    }
+    alignas(32) int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(__SSE2__)
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 2 <= n; i += 2) {
+        acc = _mm_add_epi64(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)));
+    }
+    alignas(16) int64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    sum = lanes[0] + lanes[1];
+#endif
+
+    for (; i < n; ++i) {
+        sum += values[i];
+    }
+    return sum;
+}
+
+size_t argmaxCounters(const int64_t* values, size_t n) {
+    size_t i = 0;
+    int64_t best = numeric_limits<int64_t>::min();
+
+    // First find the maximum value with wide compares, then the first
+    // position holding it, so ties resolve to the lowest index
+#if defined(__AVX2__)
+    __m256i maxv = _mm256_set1_epi64x(best);
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        maxv = _mm256_blendv_epi8(maxv, v, _mm256_cmpgt_epi64(v, maxv));
+    }
+    alignas(32) int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), maxv);
+    for (int64_t lane : lanes) {
+        best = lane > best ? lane : best;
+    }
+#elif defined(__SSE4_2__)
+    __m128i maxv = _mm_set1_epi64x(best);
+    for (; i + 2 <= n; i += 2) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        maxv = _mm_blendv_epi8(maxv, v, _mm_cmpgt_epi64(v, maxv));
+    }
+    alignas(16) int64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), maxv);
+    best = lanes[0] > lanes[1] ? lanes[0] : lanes[1];
+#endif
+
+    for (; i < n; ++i) {
+        best = values[i] > best ? values[i] : best;
+    }
+    for (i = 0; i < n; ++i) {
+        if (values[i] == best) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+// Each mirrors the #if chain of its kernel above
+const char* counterSumIsa() {
+#if defined(__AVX2__)
+    return "AVX2";
+#elif defined(__SSE2__)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+const char* counterArgmaxIsa() {
+#if defined(__AVX2__)
+    return "AVX2";
+#elif defined(__SSE4_2__)
+    return "SSE4.2";
+#else
+    return "scalar";
+#endif
+}
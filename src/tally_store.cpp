@@ -0,0 +1,309 @@
+#include "tally_store.hpp"
+#include "tally_kernels.hpp"
+#include <stdexcept>
+#include <algorithm>
+using namespace std;
+
+namespace {
+
+size_t lsb(size_t x) {
+    return x & (~x + 1);
+}
+
+size_t roundUp(size_t n, size_t multiple) {
+    return (n + multiple - 1) / multiple * multiple;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// TallyStore
+// ---------------------------------------------------------------------------
+
+size_t TallyStore::leadingSlot(size_t district, size_t slotCount) const {
+    std::vector<int64_t> row;
+    readDistrict(district, row);
+    return argmaxCounters(row.data(), std::min(slotCount, row.size())) + 1;
+}
+
+// ---------------------------------------------------------------------------
+// MatrixTallyStore
+// ---------------------------------------------------------------------------
+
+MatrixTallyStore::MatrixTallyStore(Layout layout) : layout(layout) {
+}
+
+size_t MatrixTallyStore::offset(size_t district, size_t slot) const {
+    if (layout == Layout::DistrictMajor) {
+        return district * roundUp(width, kLineWords) + (slot - 1);
+    }
+    return (slot - 1) * districtCapacity + district;
+}
+
+int64_t& MatrixTallyStore::node(size_t district, size_t slot) {
+    size_t i = offset(district, slot);
+    return lines[i / kLineWords].words[i % kLineWords];
+}
+
+int64_t MatrixTallyStore::node(size_t district, size_t slot) const {
+    size_t i = offset(district, slot);
+    return lines[i / kLineWords].words[i % kLineWords];
+}
+
+int64_t MatrixTallyStore::prefix(size_t district, size_t slot) const {
+    int64_t sum = 0;
+    while (slot > 0) {
+        sum += node(district, slot);
+        slot -= lsb(slot);
+    }
+    return sum;
+}
+
+void MatrixTallyStore::relayout(size_t newCapacity, size_t newWidth) {
+    MatrixTallyStore grown(layout);
+    grown.width = newWidth;
+    grown.districtCapacity = newCapacity;
+    grown.slotCounts = slotCounts;
+    // Both layouts keep rows a whole number of cache lines long
+    grown.lines.resize(roundUp(newCapacity, kLineWords) * roundUp(newWidth, kLineWords) / kLineWords);
+
+    for (size_t d = 0; d < slotCounts.size(); ++d) {
+        for (size_t slot = 1; slot <= slotCounts[d]; ++slot) {
+            grown.node(d, slot) = node(d, slot);
+        }
+    }
+
+    lines = std::move(grown.lines);
+    width = newWidth;
+    districtCapacity = newCapacity;
+}
+
+void MatrixTallyStore::addDistrict(size_t candidateCount) {
+    if (candidateCount == 0) {
+        throw invalid_argument("District must have at least one candidate slot");
+    }
+
+    size_t needed = slotCounts.size() + 1;
+    if (needed > districtCapacity || candidateCount > width) {
+        size_t capacity = districtCapacity;
+        while (capacity < needed) {
+            capacity = std::max(kLineWords, capacity * 2);
+        }
+        relayout(capacity, std::max(width, candidateCount));
+    }
+    slotCounts.push_back(candidateCount);
+}
+
+void MatrixTallyStore::update(size_t district, size_t slot, int64_t delta) {
+    size_t n = slotCounts[district];
+    if (slot == 0 || slot > n) {
+        throw std::out_of_range("Index out of range for tally matrix update");
+    }
+
+    while (slot <= n) {
+        node(district, slot) += delta;
+        slot += lsb(slot);
+    }
+}
+
+void MatrixTallyStore::applyDenseBatch(size_t district, const std::vector<int64_t>& slotDeltas) {
+    size_t n = slotCounts[district];
+    if (slotDeltas.size() > n) {
+        throw std::out_of_range("Too many deltas for tally matrix applyDenseBatch");
+    }
+
+    // Same single-pass carry as FenwickTree::applyDenseBatch
+    std::vector<int64_t> carry(slotDeltas.begin(), slotDeltas.end());
+    carry.resize(n, 0);
+    for (size_t slot = 1; slot <= n; ++slot) {
+        node(district, slot) += carry[slot - 1];
+        size_t parent = slot + lsb(slot);
+        if (parent <= n) {
+            carry[parent - 1] += carry[slot - 1];
+        }
+    }
+}
+
+int64_t MatrixTallyStore::getValue(size_t district, size_t slot) const {
+    if (slot == 0 || slot > slotCounts[district]) {
+        throw std::out_of_range("Index out of range for tally matrix getValue");
+    }
+    return prefix(district, slot) - prefix(district, slot - 1);
+}
+
+int64_t MatrixTallyStore::getDistrictTotal(size_t district) const {
+    return prefix(district, slotCounts[district]);
+}
+
+void MatrixTallyStore::readDistrict(size_t district, std::vector<int64_t>& out) const {
+    size_t n = slotCounts[district];
+    out.resize(n);
+    for (size_t slot = 1; slot <= n; ++slot) {
+        out[slot - 1] = node(district, slot);
+    }
+
+    // Undo the Fenwick accumulation in reverse order: each node's parent
+    // absorbed the node's final sum, so subtracting it back yields the
+    // point values in O(n)
+    for (size_t slot = n; slot >= 1; --slot) {
+        size_t parent = slot + lsb(slot);
+        if (parent <= n) {
+            out[parent - 1] -= out[slot - 1];
+        }
+    }
+}
+
+void MatrixTallyStore::loadDistrict(size_t district, const std::vector<int64_t>& values) {
+    size_t n = slotCounts[district];
+    if (values.size() != n) {
+        throw std::invalid_argument("Value count does not match district size");
+    }
+
+    for (size_t slot = 1; slot <= n; ++slot) {
+        node(district, slot) = values[slot - 1];
+    }
+    for (size_t slot = 1; slot <= n; ++slot) {
+        size_t parent = slot + lsb(slot);
+        if (parent <= n) {
+            node(district, parent) += node(district, slot);
+        }
+    }
+}
+
+size_t MatrixTallyStore::getSlotCount(size_t district) const {
+    return slotCounts[district];
+}
+
+void MatrixTallyStore::reset() {
+    std::fill(lines.begin(), lines.end(), Line{});
+}
+
+// ---------------------------------------------------------------------------
+// AdaptiveTallyStore
+// ---------------------------------------------------------------------------
+
+AdaptiveTallyStore::AdaptiveTallyStore(size_t directThreshold) : directThreshold(directThreshold) {
+}
+
+void AdaptiveTallyStore::checkSlot(size_t district, size_t slot) const {
+    if (slot == 0 || slot > entries[district].slots) {
+        throw std::out_of_range("Index out of range for adaptive tally");
+    }
+}
+
+void AdaptiveTallyStore::addDistrict(size_t candidateCount) {
+    if (candidateCount == 0) {
+        throw invalid_argument("District must have at least one candidate slot");
+    }
+
+    if (candidateCount <= directThreshold) {
+        entries.push_back({true, counters.size(), candidateCount});
+        counters.resize(counters.size() + candidateCount, 0);
+    } else {
+        trees.emplace_back(candidateCount);
+        entries.push_back({false, trees.size() - 1, candidateCount});
+    }
+}
+
+void AdaptiveTallyStore::update(size_t district, size_t slot, int64_t delta) {
+    checkSlot(district, slot);
+    const Entry& entry = entries[district];
+    if (entry.direct) {
+        counters[entry.index + slot - 1] += delta;
+    } else {
+        trees[entry.index].update(slot, delta);
+    }
+}
+
+void AdaptiveTallyStore::applyDenseBatch(size_t district, const std::vector<int64_t>& slotDeltas) {
+    const Entry& entry = entries[district];
+    if (!entry.direct) {
+        trees[entry.index].applyDenseBatch(slotDeltas);
+        return;
+    }
+
+    if (slotDeltas.size() > entry.slots) {
+        throw std::out_of_range("Too many deltas for adaptive tally applyDenseBatch");
+    }
+    for (size_t i = 0; i < slotDeltas.size(); ++i) {
+        counters[entry.index + i] += slotDeltas[i];
+    }
+}
+
+int64_t AdaptiveTallyStore::getValue(size_t district, size_t slot) const {
+    checkSlot(district, slot);
+    const Entry& entry = entries[district];
+    if (entry.direct) {
+        return counters[entry.index + slot - 1];
+    }
+    return trees[entry.index].getValue(slot);
+}
+
+int64_t AdaptiveTallyStore::getDistrictTotal(size_t district) const {
+    const Entry& entry = entries[district];
+    if (entry.direct) {
+        return sumCounters(counters.data() + entry.index, entry.slots);
+    }
+    return trees[entry.index].query(entry.slots);
+}
+
+void AdaptiveTallyStore::readDistrict(size_t district, std::vector<int64_t>& out) const {
+    const Entry& entry = entries[district];
+    if (entry.direct) {
+        auto first = counters.begin() + entry.index;
+        out.assign(first, first + entry.slots);
+    } else {
+        out = trees[entry.index].toValues();
+    }
+}
+
+void AdaptiveTallyStore::loadDistrict(size_t district, const std::vector<int64_t>& values) {
+    const Entry& entry = entries[district];
+    if (values.size() != entry.slots) {
+        throw std::invalid_argument("Value count does not match district size");
+    }
+    if (entry.direct) {
+        std::copy(values.begin(), values.end(), counters.begin() + entry.index);
+    } else {
+        trees[entry.index] = FenwickTree::fromValues(values);
+    }
+}
+
+size_t AdaptiveTallyStore::getSlotCount(size_t district) const {
+    return entries[district].slots;
+}
+
+size_t AdaptiveTallyStore::leadingSlot(size_t district, size_t slotCount) const {
+    const Entry& entry = entries[district];
+    if (!entry.direct) {
+        return TallyStore::leadingSlot(district, slotCount);
+    }
+    return argmaxCounters(counters.data() + entry.index, std::min(slotCount, entry.slots)) + 1;
+}
+
+void AdaptiveTallyStore::reset() {
+    std::fill(counters.begin(), counters.end(), 0);
+    for (auto& tree : trees) {
+        tree.reset();
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+std::unique_ptr<TallyStore> makeTallyStore(TallyStorage storage) {
+    switch (storage) {
+        case TallyStorage::DistrictMajorMatrix:
+            return std::make_unique<MatrixTallyStore>(MatrixTallyStore::Layout::DistrictMajor);
+        case TallyStorage::FixedDistrictTrees:
+            return std::make_unique<FixedFenwickTallyStore>();
+        case TallyStorage::CandidateMajorMatrix:
+            return std::make_unique<MatrixTallyStore>(MatrixTallyStore::Layout::CandidateMajor);
+        case TallyStorage::DistrictTrees:
+            return std::make_unique<FenwickTallyStore>();
+        case TallyStorage::Mapped:
+            throw std::invalid_argument("Mapped tally storage needs a file; construct MappedTallyStore directly");
+        case TallyStorage::Adaptive:
+        default:
+            return std::make_unique<AdaptiveTallyStore>();
+    }
+}
@@ -0,0 +1,199 @@
+#include "vote_history.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+using namespace std;
+
+static const char* const kWeekdays[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+static const char* const kMonths[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                      "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+static constexpr int64_t kNanosPerSecond = 1000000000;
+
+VoteHistory::VoteHistory()
+    : columns(std::make_shared<Columns>()),
+      strings(std::make_shared<StringTables>()) {}
+
+VoteHistory::VoteHistory(const VoteHistory& other)
+    : columns(std::make_shared<Columns>(*other.columns)),
+      strings(std::make_shared<StringTables>(*other.strings)),
+      reservedRows(other.size()),
+      publishedRows(other.size()),
+      precinctIdCount(other.precinctIdCount),
+      timestampLabelCount(other.timestampLabelCount),
+      precinctLookup(other.precinctLookup),
+      timestampLabelLookup(other.timestampLabelLookup) {}
+
+VoteHistory::VoteHistory(VoteHistory&& other) noexcept
+    : columns(std::move(other.columns)),
+      strings(std::move(other.strings)),
+      columnsShared(other.columnsShared),
+      reservedRows(other.size()),
+      publishedRows(other.size()),
+      precinctIdCount(other.precinctIdCount),
+      timestampLabelCount(other.timestampLabelCount),
+      precinctLookup(std::move(other.precinctLookup)),
+      timestampLabelLookup(std::move(other.timestampLabelLookup)) {}
+
+VoteHistory& VoteHistory::operator=(const VoteHistory& other) {
+    if (this != &other) {
+        *this = VoteHistory(other);
+    }
+    return *this;
+}
+
+VoteHistory& VoteHistory::operator=(VoteHistory&& other) noexcept {
+    size_t rows = other.size();
+    columns = std::move(other.columns);
+    strings = std::move(other.strings);
+    columnsShared = other.columnsShared;
+    reservedRows.store(rows, std::memory_order_relaxed);
+    publishedRows.store(rows, std::memory_order_release);
+    precinctIdCount = other.precinctIdCount;
+    timestampLabelCount = other.timestampLabelCount;
+    precinctLookup = std::move(other.precinctLookup);
+    timestampLabelLookup = std::move(other.timestampLabelLookup);
+    return *this;
+}
+
+uint32_t VoteHistory::internPrecinct(const std::string& precinctId) {
+    auto it = precinctLookup.find(precinctId);
+    if (it != precinctLookup.end()) {
+        return it->second;
+    }
+    uint32_t id = static_cast<uint32_t>(precinctIdCount);
+    strings->precinctIds.slot(id) = precinctId;
+    ++precinctIdCount;
+    precinctLookup.emplace(precinctId, id);
+    return id;
+}
+
+int64_t VoteHistory::encodeTimestamp(const std::string& text) {
+    int64_t nanoseconds;
+    if (parseClockTime(text, nanoseconds)) {
+        return nanoseconds;
+    }
+
+    // Label codes sit below any time the ctime format can express
+    auto it = timestampLabelLookup.find(text);
+    uint32_t id;
+    if (it != timestampLabelLookup.end()) {
+        id = it->second;
+    } else {
+        id = static_cast<uint32_t>(timestampLabelCount);
+        strings->timestampLabels.slot(id) = text;
+        ++timestampLabelCount;
+        timestampLabelLookup.emplace(text, id);
+    }
+    return kLabelBase + static_cast<int64_t>(id);
+}
+
+std::string VoteHistory::formatTimestamp(int64_t timestamp) const {
+    if (isLabel(timestamp)) {
+        if (!isValidTimestamp(timestamp)) {
+            throw std::out_of_range("Unknown timestamp label code");
+        }
+        return strings->timestampLabels[static_cast<size_t>(timestamp - kLabelBase)];
+    }
+    return formatClockTime(timestamp);
+}
+
+bool VoteHistory::parseClockTime(const std::string& text, int64_t& nanoseconds) {
+    char weekday[4] = {};
+    char month[4] = {};
+    int day, hour, minute, second, year;
+    int consumed = 0;
+    if (std::sscanf(text.c_str(), "%3s %3s %d %d:%d:%d %d%n",
+                    weekday, month, &day, &hour, &minute, &second, &year, &consumed) != 7 ||
+        static_cast<size_t>(consumed) != text.size()) {
+        return false;
+    }
+
+    std::tm parts = {};
+    parts.tm_mon = -1;
+    for (int m = 0; m < 12; ++m) {
+        if (std::strcmp(month, kMonths[m]) == 0) {
+            parts.tm_mon = m;
+        }
+    }
+    if (parts.tm_mon < 0) {
+        return false;
+    }
+    parts.tm_mday = day;
+    parts.tm_hour = hour;
+    parts.tm_min = minute;
+    parts.tm_sec = second;
+    parts.tm_year = year - 1900;
+    parts.tm_isdst = -1;
+
+    std::time_t seconds = std::mktime(&parts);
+    if (seconds == static_cast<std::time_t>(-1)) {
+        return false;
+    }
+    nanoseconds = static_cast<int64_t>(seconds) * kNanosPerSecond;
+    return true;
+}
+
+std::string VoteHistory::formatClockTime(int64_t nanoseconds) {
+    // Round towards the past so times before 1970 land on the right second
+    int64_t wholeSeconds = nanoseconds / kNanosPerSecond;
+    if (nanoseconds % kNanosPerSecond < 0) {
+        --wholeSeconds;
+    }
+    std::time_t seconds = static_cast<std::time_t>(wholeSeconds);
+    std::tm parts = {};
+#ifdef _WIN32
+    localtime_s(&parts, &seconds);
+#else
+    localtime_r(&seconds, &parts);
+#endif
+
+    // Same layout as ctime, without its shared static buffer
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%s %s %2d %02d:%02d:%02d %d",
+                  kWeekdays[parts.tm_wday], kMonths[parts.tm_mon], parts.tm_mday,
+                  parts.tm_hour, parts.tm_min, parts.tm_sec, parts.tm_year + 1900);
+    return buffer;
+}
+
+int64_t VoteHistory::nowNanoseconds() {
+    using namespace std::chrono;
+    static const int64_t offset =
+        duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count() -
+        duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+    return offset + duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void VoteHistory::reserve(size_t n) {
+    preallocateRows(0, n);
+}
+
+void VoteHistory::preallocateRows(size_t first, size_t last) {
+    columns->district.preallocate(first, last);
+    columns->candidate.preallocate(first, last);
+    columns->precinct.preallocate(first, last);
+    columns->timestamp.preallocate(first, last);
+    columns->delta.preallocate(first, last);
+}
+
+void VoteHistory::clear() {
+    // Rows written after a clear reuse row numbers, so shared chunks are left to their readers
+    if (columnsShared) {
+        columns = std::make_shared<Columns>();
+        columnsShared = false;
+    }
+    reservedRows.store(0, std::memory_order_relaxed);
+    publishedRows.store(0, std::memory_order_release);
+}
+
+VoteHistory VoteHistory::sharePrefix() const {
+    VoteHistory view(columns, strings);
+    size_t rows = size();
+    view.reservedRows.store(rows, std::memory_order_relaxed);
+    view.publishedRows.store(rows, std::memory_order_relaxed);
+    view.precinctIdCount = precinctIdCount;
+    view.timestampLabelCount = timestampLabelCount;
+    columnsShared = true;
+    return view;
+}
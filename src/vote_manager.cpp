@@ -1,188 +1,1076 @@
 #include "vote_manager.hpp"
+#include "tally_kernels.hpp"
 #include <algorithm>
 #include <sstream>
 #include <iomanip>
 #include <chrono>
-#include <ctime>
+#include <stdexcept>
 using namespace std;
 
-void VoteManager::addDistrict(const District& district) {
-    districts.push_back(district);
+namespace {
+
+// Field access shared by the two batch entry types
+CandidateHandle candidateOf(const std::pair<CandidateHandle, int64_t>& vote) { return vote.first; }
+int64_t countOf(const std::pair<CandidateHandle, int64_t>& vote) { return vote.second; }
+CandidateHandle candidateOf(const PrecinctVote& vote) { return vote.candidate; }
+int64_t countOf(const PrecinctVote& vote) { return vote.voteCount; }
+
+} // namespace
+
+VoteUpdate VoteHistoryView::operator[](size_t i) const {
+    return VoteUpdate((*districts)[history->districts()[i]].id,
+                      (*candidates)[history->candidates()[i]].id,
+                      history->deltas()[i],
+                      history->getPrecinctId(history->precincts()[i]),
+                      history->formatTimestamp(history->timestamps()[i]));
+}
+
+int64_t VoteSnapshot::getCandidateVotes(DistrictHandle district, CandidateHandle candidate) const {
+    if (district >= districtRows.size()) {
+        return 0;
+    }
+    const auto& row = *districtRows[district];
+    return candidate < row.size() ? row[candidate] : 0;
+}
+
+const std::vector<int64_t>& VoteSnapshot::getDistrictVotes(DistrictHandle district) const {
+    static const std::vector<int64_t> empty;
+    return district < districtRows.size() ? *districtRows[district] : empty;
+}
+
+int64_t VoteSnapshot::getDistrictTotalVotes(DistrictHandle district) const {
+    return district < districtTotals.size() ? districtTotals[district] : 0;
+}
+
+int64_t VoteSnapshot::getCandidateTotalVotes(CandidateHandle candidate) const {
+    return candidate < candidateTotals.size() ? candidateTotals[candidate] : 0;
+}
+
+CandidateHandle VoteSnapshot::getDistrictLeader(DistrictHandle district) const {
+    return district < districtLeaders.size() ? districtLeaders[district] : kInvalidHandle;
+}
+
+VoteManager::VoteManager(TallyStorage storage)
+    : storage(storage), tallies(makeTallyStore(storage)),
+      publishedSnapshot(std::make_shared<const VoteSnapshot>()) {
+}
+
+VoteManager::VoteManager(const std::string& tallyFile, MappedTallyOptions options)
+    : storage(TallyStorage::Mapped), tallies(std::make_unique<MappedTallyStore>(tallyFile, options)),
+      publishedSnapshot(std::make_shared<const VoteSnapshot>()) {
+}
+
+DistrictHandle VoteManager::addDistrict(const District& district) {
+    if (districtHandles.count(district.id)) {
+        throw std::invalid_argument("Duplicate district ID: " + district.id);
+    }
+    if (sharded) {
+        throw std::logic_error("Cannot add districts after sharding is enabled");
+    }
     
     // Create a Fenwick Tree for this district with capacity for all candidates
-    districtTrees[district.id] = std::make_unique<FenwickTree>(district.candidateCount);
+    tallies->addDistrict(district.candidateCount);
+    
+    DistrictHandle handle = static_cast<DistrictHandle>(districts.size());
+    districts.push_back(district);
+    districtHandles[district.id] = handle;
     
     // Initialize candidate indices for this district
-    candidateIndices[district.id] = std::unordered_map<std::string, size_t>();
+    candidateSlots.emplace_back();
+    slotCandidates.emplace_back();
+    bool direct = tallies->isDirect(handle);
+    districtLeaders.emplace_back(direct ? 0 : district.candidateCount);
+    directDistricts.push_back(direct);
+    dirtyDistricts.push_back(true);
+    precinctIndex.addDistrict(district.candidateCount);
+    if (versionTracking) {
+        versionedTallies.emplace_back(district.candidateCount);
+    }
+    return handle;
 }
 
-void VoteManager::addCandidate(const Candidate& candidate) {
+CandidateHandle VoteManager::addCandidate(const Candidate& candidate) {
+    if (candidateHandles.count(candidate.id)) {
+        throw std::invalid_argument("Duplicate candidate ID: " + candidate.id);
+    }
+    
+    CandidateHandle handle = static_cast<CandidateHandle>(candidates.size());
     candidates.push_back(candidate);
+    candidateHandles[candidate.id] = handle;
+    candidateTotals.append(0);
+    allDistrictsDirty = true; // Every row gains a column
+    return handle;
 }
 
 void VoteManager::assignCandidateToDistrict(const std::string& districtId, const std::string& candidateId) {
-    auto districtIt = std::find_if(districts.begin(), districts.end(),
-        [&districtId](const District& d) { return d.id == districtId; });
-    
-    if (districtIt == districts.end()) {
+    DistrictHandle district = getDistrictHandle(districtId);
+    if (district == kInvalidHandle) {
         throw std::runtime_error("District not found: " + districtId);
     }
     
-    auto candidateIt = std::find_if(candidates.begin(), candidates.end(),
-        [&candidateId](const Candidate& c) { return c.id == candidateId; });
-    
-    if (candidateIt == candidates.end()) {
+    CandidateHandle candidate = getCandidateHandle(candidateId);
+    if (candidate == kInvalidHandle) {
         throw std::runtime_error("Candidate not found: " + candidateId);
     }
     
+    assignCandidateToDistrict(district, candidate);
+}
+
+void VoteManager::assignCandidateToDistrict(DistrictHandle district, CandidateHandle candidate) {
+    if (district >= districts.size()) {
+        throw std::out_of_range("Invalid district handle");
+    }
+    if (candidate >= candidates.size()) {
+        throw std::out_of_range("Invalid candidate handle");
+    }
+    
+    auto& slots = candidateSlots[district];
+    if (candidate >= slots.size()) {
+        slots.resize(candidate + 1, 0);
+    }
+    if (slots[candidate] != 0) {
+        return; // Already assigned
+    }
+    
     // Assign the next available index in this district
-    size_t nextIndex = candidateIndices[districtId].size() + 1;
-    candidateIndices[districtId][candidateId] = nextIndex;
+    auto& assigned = slotCandidates[district];
+    assigned.push_back(candidate);
+    slots[candidate] = assigned.size();
+    
+    // Slots past the tree size are rejected by addVotes, so only track real ones
+    if (assigned.size() <= districtLeaders[district].size()) {
+        districtLeaders[district].activate(assigned.size() - 1);
+    }
+    
+    // A reopened mapped store already holds this slot's votes
+    if (assigned.size() <= tallies->getSlotCount(district)) {
+        int64_t stored = tallies->getValue(district, assigned.size());
+        if (stored != 0) {
+            if (!directDistricts[district]) {
+                districtLeaders[district].add(assigned.size() - 1, stored);
+            }
+            candidateTotals.add(candidate, stored);
+        }
+    }
+    dirtyDistricts[district] = true;
+}
+
+DistrictHandle VoteManager::getDistrictHandle(const std::string& districtId) const {
+    auto it = districtHandles.find(districtId);
+    return it == districtHandles.end() ? kInvalidHandle : it->second;
+}
+
+CandidateHandle VoteManager::getCandidateHandle(const std::string& candidateId) const {
+    auto it = candidateHandles.find(candidateId);
+    return it == candidateHandles.end() ? kInvalidHandle : it->second;
 }
 
 void VoteManager::addVotes(const std::string& districtId, const std::string& candidateId, 
                            int64_t voteCount, const std::string& precinctId, const std::string& timestamp) {
     // Validate district exists
-    auto districtIt = districtTrees.find(districtId);
-    if (districtIt == districtTrees.end()) {
+    DistrictHandle district = getDistrictHandle(districtId);
+    if (district == kInvalidHandle) {
         throw std::runtime_error("District not found: " + districtId);
     }
     
     // Validate candidate exists in this district
-    auto candidateIndexIt = candidateIndices.find(districtId);
-    if (candidateIndexIt == candidateIndices.end()) {
-        throw std::runtime_error("No candidates assigned to district: " + districtId);
+    CandidateHandle candidate = getCandidateHandle(candidateId);
+    if (candidate == kInvalidHandle || slotOf(district, candidate) == 0) {
+        throw std::runtime_error("Candidate not found in district: " + candidateId + " in " + districtId);
     }
     
-    auto indexIt = candidateIndexIt->second.find(candidateId);
-    if (indexIt == candidateIndexIt->second.end()) {
-        throw std::runtime_error("Candidate not found in district: " + candidateId + " in " + districtId);
+    addVotes(district, candidate, voteCount, precinctId, timestamp);
+}
+
+void VoteManager::addVotes(DistrictHandle district, CandidateHandle candidate,
+                           int64_t voteCount, const std::string& precinctId, const std::string& timestamp) {
+    addVotes(district, candidate, voteCount, precinctId, voteHistory.encodeTimestamp(timestamp));
+}
+
+void VoteManager::addVotes(DistrictHandle district, CandidateHandle candidate,
+                           int64_t voteCount, const std::string& precinctId, int64_t timestampNs) {
+    VoteStatus status = tryAddVotes(district, candidate, voteCount, precinctId, timestampNs);
+    if (status != VoteStatus::Ok) {
+        throwVoteError(status, district, candidate);
+    }
+}
+
+VoteStatus VoteManager::tryAddVotes(const std::string& districtId, const std::string& candidateId,
+                                    int64_t voteCount, const std::string& precinctId, int64_t timestampNs) {
+    DistrictHandle district = getDistrictHandle(districtId);
+    if (district == kInvalidHandle) {
+        return VoteStatus::UnknownDistrict;
+    }
+    CandidateHandle candidate = getCandidateHandle(candidateId);
+    if (candidate == kInvalidHandle) {
+        return VoteStatus::UnknownCandidate;
+    }
+    return tryAddVotes(district, candidate, voteCount, precinctId, timestampNs);
+}
+
+VoteStatus VoteManager::tryAddVotes(DistrictHandle district, CandidateHandle candidate,
+                                    int64_t voteCount, const std::string& precinctId, int64_t timestampNs) {
+    size_t candidateIndex = 0;
+    VoteStatus status = checkVote(district, candidate, candidateIndex);
+    if (status != VoteStatus::Ok) {
+        return status;
+    }
+    if (!voteHistory.isValidTimestamp(timestampNs)) {
+        return VoteStatus::InvalidTimestamp;
+    }
+    
+    if (writeAheadLog) {
+        writeAheadLog->appendVote(district, candidate, voteCount, precinctId, timestampNs,
+                                  VoteHistory::isLabel(timestampNs) ? voteHistory.formatTimestamp(timestampNs) : std::string());
     }
     
     // Update the Fenwick Tree (1-based indexing)
-    size_t candidateIndex = indexIt->second;
-    districtIt->second->update(candidateIndex, voteCount);
+    tallies->update(district, candidateIndex, voteCount);
+    ++tallyVersion;
+    dirtyDistricts[district] = true;
+    if (versionTracking) {
+        versionedTallies[district].update(candidateIndex, voteCount, tallyVersion);
+    }
+    recordVersionTime(timestampNs);
+    if (!directDistricts[district]) {
+        districtLeaders[district].add(candidateIndex - 1, voteCount);
+    }
+    candidateTotals.add(candidate, voteCount);
+    
+    // Record the vote update for audit and in its precinct's row
+    uint32_t precinct = voteHistory.internPrecinct(precinctId);
+    precinctIndex.add(precinctIndex.addPrecinct(district, precinct), candidateIndex, voteCount);
+    voteHistory.append(district, candidate, voteCount, precinct, timestampNs);
+    checkpointIfDue();
+    return VoteStatus::Ok;
+}
+
+void VoteManager::throwVoteError(VoteStatus status, DistrictHandle district, CandidateHandle candidate) const {
+    switch (status) {
+        case VoteStatus::UnknownDistrict:
+            throw std::out_of_range("Invalid district handle");
+        case VoteStatus::UnknownCandidate:
+            throw std::out_of_range("Invalid candidate handle");
+        case VoteStatus::CandidateNotInDistrict:
+            throw std::runtime_error("Candidate not found in district: " + candidates[candidate].id +
+                                     " in " + districts[district].id);
+        case VoteStatus::DistrictFull:
+            throw std::out_of_range("Candidate index exceeds district size: " + candidates[candidate].id);
+        case VoteStatus::UnknownPrecinct:
+            throw std::out_of_range("Invalid precinct id");
+        case VoteStatus::InvalidTimestamp:
+            throw std::invalid_argument("Invalid timestamp label code");
+        default:
+            throw std::logic_error("No error for a successful vote status");
+    }
+}
+
+void VoteManager::addVotesBatch(DistrictHandle district,
+                                const std::vector<std::pair<CandidateHandle, int64_t>>& votes,
+                                const std::string& precinctId, const std::string& timestamp) {
+    addVotesBatch(district, votes, precinctId, voteHistory.encodeTimestamp(timestamp));
+}
+
+void VoteManager::addVotesBatch(DistrictHandle district,
+                                const std::vector<std::pair<CandidateHandle, int64_t>>& votes,
+                                const std::string& precinctId, int64_t timestampNs) {
+    VoteStatus status = tryAddVotesBatch(district, votes, precinctId, timestampNs);
+    if (status == VoteStatus::Ok) {
+        return;
+    }
+    // Find the entry that failed, only to name it in the message
+    for (const auto& vote : votes) {
+        size_t slot = 0;
+        if (checkVote(district, vote.first, slot) == status) {
+            throwVoteError(status, district, vote.first);
+        }
+    }
+    throwVoteError(status, district, 0);
+}
+
+VoteStatus VoteManager::tryAddVotesBatch(DistrictHandle district,
+                                         const std::vector<std::pair<CandidateHandle, int64_t>>& votes,
+                                         const std::string& precinctId, int64_t timestampNs) {
+    // One precinct lookup for the whole batch, made once it is known to apply
+    uint32_t precinct = kInvalidHandle;
+    auto precinctOf = [&](size_t) {
+        if (precinct == kInvalidHandle) {
+            precinct = voteHistory.internPrecinct(precinctId);
+        }
+        return precinct;
+    };
+    return applyVotes(district, votes, precinctOf, timestampNs);
+}
+
+VoteStatus VoteManager::tryAddVotesBatch(DistrictHandle district, const std::vector<PrecinctVote>& votes,
+                                         int64_t timestampNs) {
+    size_t precinctCount = voteHistory.getPrecinctIdCount();
+    for (const PrecinctVote& vote : votes) {
+        if (vote.precinct >= precinctCount) {
+            return VoteStatus::UnknownPrecinct;
+        }
+    }
+    return applyVotes(district, votes, [&](size_t i) { return votes[i].precinct; }, timestampNs);
+}
+
+template <typename Vote, typename PrecinctOf>
+VoteStatus VoteManager::applyVotes(DistrictHandle district, const std::vector<Vote>& votes,
+                                   PrecinctOf precinctOf, int64_t timestampNs) {
+    if (district >= districts.size()) {
+        return VoteStatus::UnknownDistrict;
+    }
+    if (!voteHistory.isValidTimestamp(timestampNs)) {
+        return VoteStatus::InvalidTimestamp;
+    }
+    
+    // Validate the whole batch and fold it into one delta per tree index
+    std::vector<int64_t> slotDeltas(districts[district].candidateCount, 0);
+    for (const auto& vote : votes) {
+        size_t candidateIndex = 0;
+        VoteStatus status = checkVote(district, candidateOf(vote), candidateIndex);
+        if (status != VoteStatus::Ok) {
+            return status;
+        }
+        slotDeltas[candidateIndex - 1] += countOf(vote);
+    }
+    
+    // One log record for the whole batch, so recovery applies all of it or none
+    if (writeAheadLog) {
+        std::vector<WalBatchEntry> entries;
+        entries.reserve(votes.size());
+        for (size_t i = 0; i < votes.size(); ++i) {
+            entries.push_back({candidateOf(votes[i]), countOf(votes[i]), voteHistory.getPrecinctId(precinctOf(i))});
+        }
+        writeAheadLog->appendBatch(district, entries, timestampNs,
+                                   VoteHistory::isLabel(timestampNs) ? voteHistory.formatTimestamp(timestampNs)
+                                                                     : std::string());
+    }
+    
+    tallies->applyDenseBatch(district, slotDeltas);
+    ++tallyVersion;
+    dirtyDistricts[district] = true;
+    if (versionTracking) {
+        for (size_t slot = 0; slot < slotDeltas.size(); ++slot) {
+            if (slotDeltas[slot] != 0) {
+                versionedTallies[district].update(slot + 1, slotDeltas[slot], tallyVersion);
+            }
+        }
+    }
+    recordVersionTime(timestampNs);
     
-    // Record the vote update for audit
-    voteHistory.emplace_back(districtId, candidateId, voteCount, precinctId, timestamp);
+    for (size_t i = 0; i < votes.size(); ++i) {
+        CandidateHandle candidate = candidateOf(votes[i]);
+        int64_t voteCount = countOf(votes[i]);
+        size_t candidateIndex = slotOf(district, candidate);
+        if (!directDistricts[district]) {
+            districtLeaders[district].add(candidateIndex - 1, voteCount);
+        }
+        candidateTotals.add(candidate, voteCount);
+        precinctIndex.add(precinctIndex.addPrecinct(district, precinctOf(i)), candidateIndex, voteCount);
+    }
+    
+    // One history reservation for the whole batch; nothing between it and
+    // publishRows may throw, or later appends would wait on it forever
+    size_t row = voteHistory.reserveRows(votes.size());
+    for (size_t i = 0; i < votes.size(); ++i) {
+        voteHistory.setRow(row + i, district, candidateOf(votes[i]), countOf(votes[i]), precinctOf(i), timestampNs);
+    }
+    voteHistory.publishRows(row, votes.size());
+    checkpointIfDue();
+    return VoteStatus::Ok;
+}
+
+VoteStatus VoteManager::applyPrecinctReport(DistrictHandle district, const std::string& precinctId,
+                                            const std::vector<std::pair<CandidateHandle, int64_t>>& votes,
+                                            int64_t timestampNs) {
+    // Snapshots stay lazy: the next publishSnapshot() rebuilds only the dirty rows
+    return tryAddVotesBatch(district, votes, precinctId, timestampNs);
+}
+
+VoteStatus VoteManager::validateVote(DistrictHandle district, CandidateHandle candidate) const {
+    size_t slot = 0;
+    return checkVote(district, candidate, slot);
+}
+
+PrecinctHandle VoteManager::addPrecinct(DistrictHandle district, const std::string& precinctId) {
+    if (district >= districts.size()) {
+        throw std::out_of_range("Invalid district handle");
+    }
+    uint32_t id = voteHistory.internPrecinct(precinctId);
+    PrecinctHandle existing = precinctIndex.find(district, id);
+    if (existing != PrecinctIndex::npos) {
+        return existing;
+    }
+    if (writeAheadLog) {
+        writeAheadLog->appendPrecinct(district, precinctId);
+    }
+    return precinctIndex.addPrecinct(district, id);
+}
+
+PrecinctHandle VoteManager::getPrecinctHandle(DistrictHandle district, const std::string& precinctId) const {
+    uint32_t precinct = voteHistory.findPrecinct(precinctId);
+    if (district >= districts.size() || precinct == UINT32_MAX) {
+        return PrecinctIndex::npos;
+    }
+    return precinctIndex.find(district, precinct);
+}
+
+int64_t VoteManager::getPrecinctVotes(PrecinctHandle precinct, CandidateHandle candidate) const {
+    if (precinct >= precinctIndex.size()) {
+        throw std::out_of_range("Invalid precinct handle");
+    }
+    size_t slot = slotOf(precinctIndex.getDistrict(precinct), candidate);
+    if (slot == 0 || slot > districts[precinctIndex.getDistrict(precinct)].candidateCount) {
+        return 0;
+    }
+    return precinctIndex.getVotes(precinct, slot);
+}
+
+int64_t VoteManager::getPrecinctTotalVotes(PrecinctHandle precinct) const {
+    if (precinct >= precinctIndex.size()) {
+        throw std::out_of_range("Invalid precinct handle");
+    }
+    return precinctIndex.getTotal(precinct);
+}
+
+bool VoteManager::isPrecinctReported(PrecinctHandle precinct) const {
+    if (precinct >= precinctIndex.size()) {
+        throw std::out_of_range("Invalid precinct handle");
+    }
+    return precinctIndex.isReported(precinct);
+}
+
+size_t VoteManager::getPrecinctCount(DistrictHandle district) const {
+    if (district >= districts.size()) {
+        throw std::out_of_range("Invalid district handle");
+    }
+    return precinctIndex.getPrecinctCount(district);
+}
+
+size_t VoteManager::getReportedPrecinctCount(DistrictHandle district) const {
+    if (district >= districts.size()) {
+        throw std::out_of_range("Invalid district handle");
+    }
+    return precinctIndex.getReportedCount(district);
+}
+
+uint32_t VoteManager::internPrecinct(const std::string& precinctId) {
+    return voteHistory.internPrecinct(precinctId);
+}
+
+void VoteManager::reserveHistory(size_t additionalUpdates) {
+    voteHistory.reserve(voteHistory.size() + additionalUpdates);
+}
+
+void VoteManager::enableSharding(size_t shardCount) {
+    if (sharded) {
+        throw std::logic_error("Sharding is already enabled");
+    }
+    
+    std::vector<size_t> slotCounts;
+    for (DistrictHandle handle = 0; handle < districts.size(); ++handle) {
+        slotCounts.push_back(tallies->getSlotCount(handle));
+    }
+    sharded = std::make_unique<ShardedState>(slotCounts, shardCount);
+}
+
+void VoteManager::addVotesSharded(size_t shard, DistrictHandle district, CandidateHandle candidate, int64_t voteCount) {
+    if (!sharded) {
+        throw std::logic_error("Sharding is not enabled");
+    }
+    if (district >= districts.size()) {
+        throw std::out_of_range("Invalid district handle");
+    }
+    if (candidate >= candidates.size()) {
+        throw std::out_of_range("Invalid candidate handle");
+    }
+    
+    size_t candidateIndex = slotOf(district, candidate);
+    if (candidateIndex == 0) {
+        throw std::runtime_error("Candidate not found in district: " + candidates[candidate].id +
+                                 " in " + districts[district].id);
+    }
+    
+    sharded->tally.add(shard, district, candidateIndex, voteCount);
+}
+
+std::shared_ptr<const VoteManager::MergedTotals> VoteManager::mergedTotals() const {
+    std::lock_guard<std::mutex> lock(sharded->mergeMutex);
+    
+    // Read the epoch before merging: a write racing with the merge may be
+    // included, but the next call will see a newer epoch and merge again
+    uint64_t epoch = sharded->tally.epoch();
+    const auto& cached = sharded->merged;
+    if (cached && cached->tallyVersion == tallyVersion && cached->shardEpoch == epoch) {
+        return cached;
+    }
+    
+    auto merged = std::make_shared<MergedTotals>();
+    merged->tallyVersion = tallyVersion;
+    merged->shardEpoch = epoch;
+    merged->candidateTotals.assign(candidates.size(), 0);
+    
+    std::vector<int64_t> row;
+    for (DistrictHandle handle = 0; handle < districts.size(); ++handle) {
+        tallies->readDistrict(handle, row);
+        sharded->tally.accumulateDistrict(handle, row);
+        
+        const auto& assigned = slotCandidates[handle];
+        size_t active = std::min(assigned.size(), row.size());
+        for (size_t slot = 0; slot < active; ++slot) {
+            merged->candidateTotals[assigned[slot]] += row[slot];
+        }
+        merged->districtTotals.push_back(sumCounters(row.data(), row.size()));
+        merged->districtLeaders.push_back(active == 0 ? kInvalidHandle
+                                                      : assigned[argmaxCounters(row.data(), active)]);
+    }
+    merged->overallLeader = candidates.empty() ? kInvalidHandle
+        : static_cast<CandidateHandle>(argmaxCounters(merged->candidateTotals.data(), candidates.size()));
+    
+    sharded->merged = merged;
+    return merged;
 }
 
 int64_t VoteManager::getCandidateVotes(const std::string& districtId, const std::string& candidateId) const {
-    auto districtIt = districtTrees.find(districtId);
-    if (districtIt == districtTrees.end()) {
+    DistrictHandle district = getDistrictHandle(districtId);
+    CandidateHandle candidate = getCandidateHandle(candidateId);
+    if (district == kInvalidHandle || candidate == kInvalidHandle) {
         return 0;
     }
     
-    auto candidateIndexIt = candidateIndices.find(districtId);
-    if (candidateIndexIt == candidateIndices.end()) {
+    return getCandidateVotes(district, candidate);
+}
+
+int64_t VoteManager::getCandidateVotes(DistrictHandle district, CandidateHandle candidate) const {
+    if (district >= districts.size()) {
         return 0;
     }
     
-    auto indexIt = candidateIndexIt->second.find(candidateId);
-    if (indexIt == candidateIndexIt->second.end()) {
+    size_t candidateIndex = slotOf(district, candidate);
+    if (candidateIndex == 0) {
         return 0;
     }
     
     // Get the value at the candidate's index (1-based)
-    return districtIt->second->getValue(indexIt->second);
+    int64_t votes = tallies->getValue(district, candidateIndex);
+    if (sharded) {
+        votes += sharded->tally.getValue(district, candidateIndex);
+    }
+    return votes;
 }
 
-int64_t VoteManager::getCandidateTotalVotes(const std::string& candidateId) const {
-    int64_t total = 0;
+std::vector<int64_t> VoteManager::getDistrictVotes(DistrictHandle district) const {
+    std::vector<int64_t> votes(candidates.size(), 0);
+    if (district >= districts.size()) {
+        return votes;
+    }
     
-    for (const auto& district : districts) {
-        total += getCandidateVotes(district.id, candidateId);
+    std::vector<int64_t> row;
+    tallies->readDistrict(district, row);
+    if (sharded) {
+        sharded->tally.accumulateDistrict(district, row);
+    }
+    const auto& assigned = slotCandidates[district];
+    for (size_t slot = 0; slot < assigned.size() && slot < row.size(); ++slot) {
+        votes[assigned[slot]] = row[slot];
+    }
+    return votes;
+}
+
+int64_t VoteManager::getCandidateTotalVotes(const std::string& candidateId) const {
+    CandidateHandle candidate = getCandidateHandle(candidateId);
+    if (candidate == kInvalidHandle) {
+        return 0;
     }
     
-    return total;
+    return getCandidateTotalVotes(candidate);
+}
+
+int64_t VoteManager::getCandidateTotalVotes(CandidateHandle candidate) const {
+    if (candidate >= candidateTotals.size()) {
+        return 0;
+    }
+    return sharded ? mergedTotals()->candidateTotals[candidate] : candidateTotals.value(candidate);
 }
 
 int64_t VoteManager::getDistrictTotalVotes(const std::string& districtId) const {
-    auto districtIt = districtTrees.find(districtId);
-    if (districtIt == districtTrees.end()) {
+    DistrictHandle district = getDistrictHandle(districtId);
+    if (district == kInvalidHandle) {
+        return 0;
+    }
+    
+    return getDistrictTotalVotes(district);
+}
+
+int64_t VoteManager::getDistrictTotalVotes(DistrictHandle district) const {
+    if (district >= districts.size()) {
         return 0;
     }
     
+    if (sharded) {
+        return mergedTotals()->districtTotals[district];
+    }
+    
     // Get the sum of all candidates in this district
-    return districtIt->second->query(districtIt->second->getSize());
+    return tallies->getDistrictTotal(district);
 }
 
     string VoteManager::getDistrictLeader(const std::string& districtId) const {
-    auto districtIt = districtTrees.find(districtId);
-    if (districtIt == districtTrees.end()) {
+    DistrictHandle district = getDistrictHandle(districtId);
+    if (district == kInvalidHandle) {
         return "";
     }
     
-    auto candidateIndexIt = candidateIndices.find(districtId);
-    if (candidateIndexIt == candidateIndices.end()) {
-        return "";
+    CandidateHandle leader = getDistrictLeader(district);
+    return leader == kInvalidHandle ? "" : candidates[leader].id;
+}
+
+CandidateHandle VoteManager::getDistrictLeader(DistrictHandle district) const {
+    if (district >= districts.size()) {
+        return kInvalidHandle;
+    }
+    if (sharded) {
+        return mergedTotals()->districtLeaders[district];
     }
     
-        string leaderId = "";
-    int64_t maxVotes = -1;
-    
-    // Find the candidate with the most votes in this district
-    for (const auto& candidate : candidates) {
-        int64_t votes = getCandidateVotes(districtId, candidate.id);
-        if (votes > maxVotes) {
-            maxVotes = votes;
-            leaderId = candidate.id;
+    const auto& assigned = slotCandidates[district];
+    if (directDistricts[district]) {
+        size_t active = std::min(assigned.size(), tallies->getSlotCount(district));
+        if (active == 0) {
+            return kInvalidHandle;
         }
+        return assigned[tallies->leadingSlot(district, active) - 1];
     }
     
-    return leaderId;
+    size_t leaderIndex = districtLeaders[district].leader();
+    if (leaderIndex == LeaderTracker::npos) {
+        return kInvalidHandle;
+    }
+    return assigned[leaderIndex];
 }
 
     string VoteManager::getOverallLeader() const {
-        string leaderId = "";
-    int64_t maxVotes = -1;
+    CandidateHandle leader = getOverallLeaderHandle();
+    return leader == kInvalidHandle ? "" : candidates[leader].id;
+}
+
+CandidateHandle VoteManager::getOverallLeaderHandle() const {
+    if (sharded) {
+        return mergedTotals()->overallLeader;
+    }
+    size_t leaderIndex = candidateTotals.leader();
+    return leaderIndex == LeaderTracker::npos ? kInvalidHandle : static_cast<CandidateHandle>(leaderIndex);
+}
+
+void VoteManager::resetVotes() {
+    if (writeAheadLog) {
+        writeAheadLog->appendReset();
+    }
+    tallies->reset();
+    for (auto& leaders : districtLeaders) {
+        leaders.reset();
+    }
+    candidateTotals.reset();
+    if (sharded) {
+        sharded->tally.reset();
+    }
+    voteHistory.clear();
+    precinctIndex.reset();
+    ++tallyVersion;
+    allDistrictsDirty = true;
+    for (auto& versions : versionedTallies) {
+        versions.reset(tallyVersion);
+    }
+    checkpointIfDue();
+}
+
+void VoteManager::enableWriteAheadLog(const std::string& path, WalOptions options) {
+    if (writeAheadLog) {
+        throw std::logic_error("Write-ahead log is already enabled");
+    }
+    writeAheadLog = std::make_unique<WriteAheadLog>(path, options);
+}
+
+WalReadResult VoteManager::recoverFromLog(const std::string& path, uint64_t afterSequence) {
+    if (writeAheadLog) {
+        throw std::logic_error("Recover before enabling the write-ahead log");
+    }
+    
+    uint64_t replayed = 0;
+    WalReadResult result = WriteAheadLog::read(path, [&](const WalRecord& record) {
+        if (record.sequence <= afterSequence) {
+            return; // Already covered by a checkpoint
+        }
+        ++replayed;
+        if (record.type == WalRecord::Type::Reset) {
+            resetVotes();
+        } else if (record.type == WalRecord::Type::Precinct) {
+            addPrecinct(record.district, record.precinctId);
+        } else if (record.type == WalRecord::Type::Batch) {
+            std::vector<PrecinctVote> votes;
+            votes.reserve(record.entries.size());
+            for (const WalBatchEntry& entry : record.entries) {
+                votes.push_back({entry.candidate, entry.delta, voteHistory.internPrecinct(entry.precinctId)});
+            }
+            int64_t timestamp = record.timestampLabel.empty() ? record.timestampNs
+                                                              : voteHistory.encodeTimestamp(record.timestampLabel);
+            VoteStatus status = tryAddVotesBatch(record.district, votes, timestamp);
+            if (status != VoteStatus::Ok) {
+                throw std::runtime_error("Write-ahead log batch does not match the district assignments");
+            }
+        } else if (!record.timestampLabel.empty()) {
+            addVotes(record.district, record.candidate, record.delta, record.precinctId, record.timestampLabel);
+        } else {
+            addVotes(record.district, record.candidate, record.delta, record.precinctId, record.timestampNs);
+        }
+    });
+    result.records = replayed;
+    return result;
+}
+
+std::shared_ptr<CheckpointData> VoteManager::captureCheckpoint() const {
+    auto data = std::make_shared<CheckpointData>();
+    data->walSequence = writeAheadLog ? writeAheadLog->getLastSequence() : 0;
+    data->tallyVersion = tallyVersion;
     
-    // Find the candidate with the most total votes across all districts
+    data->candidates.reserve(candidates.size());
     for (const auto& candidate : candidates) {
-        int64_t totalVotes = getCandidateTotalVotes(candidate.id);
-        if (totalVotes > maxVotes) {
-            maxVotes = totalVotes;
-            leaderId = candidate.id;
+        data->candidates.push_back({candidate.name, candidate.party, candidate.id});
+    }
+    
+    data->districts.resize(districts.size());
+    for (DistrictHandle handle = 0; handle < districts.size(); ++handle) {
+        auto& district = data->districts[handle];
+        district.name = districts[handle].name;
+        district.id = districts[handle].id;
+        district.candidateCount = districts[handle].candidateCount;
+        district.assigned = slotCandidates[handle];
+        tallies->readDistrict(handle, district.values);
+        if (sharded) {
+            sharded->tally.accumulateDistrict(handle, district.values);
         }
     }
     
-    return leaderId;
+    data->precincts.reserve(precinctIndex.size());
+    for (PrecinctHandle precinct = 0; precinct < precinctIndex.size(); ++precinct) {
+        data->precincts.push_back({precinctIndex.getDistrict(precinct), precinctIndex.getPrecinctId(precinct)});
+    }
+    
+    // The history is shared, not copied; the writer thread reads only the rows published so far
+    data->history = voteHistory.sharePrefix();
+    return data;
 }
 
-void VoteManager::resetVotes() {
-    for (auto& districtTree : districtTrees) {
-        districtTree.second->reset();
+void VoteManager::writeCheckpoint(const std::string& path) const {
+    writeCheckpointFile(path, *captureCheckpoint());
+}
+
+void VoteManager::enableCheckpoints(const std::string& path, uint64_t updateInterval) {
+    if (checkpointWriter) {
+        throw std::logic_error("Checkpoints are already enabled");
+    }
+    if (updateInterval == 0) {
+        throw std::invalid_argument("Checkpoint interval must be positive");
+    }
+    checkpointWriter = std::make_unique<CheckpointWriter>(path, writeAheadLog.get());
+    checkpointInterval = updateInterval;
+    changesSinceCheckpoint = 0;
+}
+
+void VoteManager::checkpointIfDue() {
+    if (checkpointWriter && ++changesSinceCheckpoint >= checkpointInterval) {
+        changesSinceCheckpoint = 0;
+        checkpointWriter->submit(captureCheckpoint());
     }
-    voteHistory.clear();
+}
+
+WalReadResult VoteManager::restoreFromCheckpoint(const std::string& checkpointPath, const std::string& walPath) {
+    if (!districts.empty() || !candidates.empty() || sharded || versionTracking) {
+        throw std::logic_error("Restore into an empty vote manager");
+    }
+    
+    CheckpointData data = readCheckpointFile(checkpointPath);
+    for (const auto& candidate : data.candidates) {
+        addCandidate(Candidate(candidate.name, candidate.party, candidate.id));
+    }
+    
+    // Size every per-district array once rather than growing it 100k times
+    size_t districtCount = data.districts.size();
+    districts.reserve(districtCount);
+    districtHandles.reserve(districtCount);
+    candidateSlots.reserve(districtCount);
+    slotCandidates.reserve(districtCount);
+    districtLeaders.reserve(districtCount);
+    directDistricts.reserve(districtCount);
+    dirtyDistricts.reserve(districtCount);
+    
+    for (const auto& district : data.districts) {
+        DistrictHandle handle = addDistrict(District(district.name, district.id,
+                                                     static_cast<size_t>(district.candidateCount)));
+        for (CandidateHandle candidate : district.assigned) {
+            assignCandidateToDistrict(handle, candidate);
+        }
+        if (district.values.size() != tallies->getSlotCount(handle)) {
+            throw std::runtime_error("Checkpoint tallies do not match district size: " + district.id);
+        }
+        
+        // Linear-time bulk load, then seed the leaders and running totals
+        tallies->loadDistrict(handle, district.values);
+        size_t active = std::min(district.assigned.size(), district.values.size());
+        for (size_t slot = 0; slot < active; ++slot) {
+            int64_t votes = district.values[slot];
+            if (votes == 0) {
+                continue;
+            }
+            if (!directDistricts[handle]) {
+                districtLeaders[handle].add(slot, votes);
+            }
+            candidateTotals.add(district.assigned[slot], votes);
+        }
+    }
+    
+    voteHistory = std::move(data.history);
+    tallyVersion = data.tallyVersion;
+    
+    // Declaring the precincts in handle order keeps every handle, including
+    // precincts that have not reported. The history since the last reset is
+    // exactly what the precinct rows hold.
+    for (const auto& precinct : data.precincts) {
+        if (precinct.district >= districts.size() || precinct.precinctId >= voteHistory.getPrecinctIdCount()) {
+            throw std::runtime_error("Checkpoint precinct does not match the districts");
+        }
+        precinctIndex.addPrecinct(precinct.district, precinct.precinctId);
+    }
+    for (size_t row = 0; row < voteHistory.size(); ++row) {
+        DistrictHandle district = voteHistory.districts()[row];
+        size_t candidateIndex = slotOf(district, voteHistory.candidates()[row]);
+        if (candidateIndex == 0 || candidateIndex > districts[district].candidateCount) {
+            throw std::runtime_error("Checkpoint history does not match the district assignments");
+        }
+        PrecinctHandle precinct = precinctIndex.addPrecinct(district, voteHistory.precincts()[row]);
+        precinctIndex.add(precinct, candidateIndex, voteHistory.deltas()[row]);
+    }
+    allDistrictsDirty = true;
+    
+    return recoverFromLog(walPath, data.walSequence);
+}
+
+void VoteManager::enableVersionTracking() {
+    if (versionTracking) {
+        return;
+    }
+    
+    // Seed each district with its current values as the first version
+    std::vector<int64_t> row;
+    for (DistrictHandle handle = 0; handle < districts.size(); ++handle) {
+        versionedTallies.emplace_back(tallies->getSlotCount(handle));
+        tallies->readDistrict(handle, row);
+        for (size_t slot = 0; slot < row.size(); ++slot) {
+            if (row[slot] != 0) {
+                versionedTallies.back().update(slot + 1, row[slot], tallyVersion);
+            }
+        }
+        versionedTallies.back().compact(tallyVersion);
+    }
+    versionTimes.clear();
+    versionTimeBase = tallyVersion;
+    versionTracking = true;
+}
+
+uint64_t VoteManager::getOldestVersion() const {
+    uint64_t oldest = 0;
+    for (const auto& versions : versionedTallies) {
+        oldest = std::max(oldest, versions.getOldestVersion());
+    }
+    return oldest;
+}
+
+int64_t VoteManager::getCandidateVotesAt(DistrictHandle district, CandidateHandle candidate, uint64_t version) const {
+    if (!versionTracking) {
+        throw std::logic_error("Version tracking is not enabled");
+    }
+    if (version > tallyVersion) {
+        throw std::out_of_range("Version has not been reached yet");
+    }
+    if (district >= districts.size()) {
+        return 0;
+    }
+    
+    size_t candidateIndex = slotOf(district, candidate);
+    const auto& versions = versionedTallies[district];
+    if (candidateIndex == 0 || candidateIndex > versions.getSize()) {
+        return 0;
+    }
+    return versions.getValueAt(candidateIndex, version);
+}
+
+int64_t VoteManager::getCandidateVotesAt(const std::string& districtId, const std::string& candidateId,
+                                         uint64_t version) const {
+    DistrictHandle district = getDistrictHandle(districtId);
+    CandidateHandle candidate = getCandidateHandle(candidateId);
+    if (district == kInvalidHandle || candidate == kInvalidHandle) {
+        return 0;
+    }
+    
+    return getCandidateVotesAt(district, candidate, version);
+}
+
+int64_t VoteManager::getDistrictTotalVotesAt(DistrictHandle district, uint64_t version) const {
+    if (!versionTracking) {
+        throw std::logic_error("Version tracking is not enabled");
+    }
+    if (version > tallyVersion) {
+        throw std::out_of_range("Version has not been reached yet");
+    }
+    if (district >= districts.size()) {
+        return 0;
+    }
+    
+    const auto& versions = versionedTallies[district];
+    return versions.queryAt(versions.getSize(), version);
+}
+
+uint64_t VoteManager::getVersionAt(int64_t timestampNs) const {
+    if (!versionTracking) {
+        throw std::logic_error("Version tracking is not enabled");
+    }
+    auto after = std::upper_bound(versionTimes.begin(), versionTimes.end(), timestampNs,
+                                  [](int64_t time, const VersionTime& entry) { return time < entry.timestampNs; });
+    return after == versionTimes.begin() ? versionTimeBase : std::prev(after)->version;
+}
+
+uint64_t VoteManager::getVersionAt(const std::string& clockTime) const {
+    int64_t timestampNs;
+    if (!VoteHistory::parseClockTime(clockTime, timestampNs)) {
+        throw std::invalid_argument("Not a ctime-style time: " + clockTime);
+    }
+    return getVersionAt(timestampNs);
+}
+
+void VoteManager::compactVersions(uint64_t checkpoint) {
+    checkpoint = std::min(checkpoint, tallyVersion);
+    for (auto& versions : versionedTallies) {
+        versions.compact(checkpoint);
+    }
+    
+    // Entries up to the checkpoint now all resolve to it
+    auto kept = std::upper_bound(versionTimes.begin(), versionTimes.end(), checkpoint,
+                                 [](uint64_t version, const VersionTime& entry) { return version < entry.version; });
+    versionTimes.erase(versionTimes.begin(), kept);
+    versionTimeBase = std::max(versionTimeBase, checkpoint);
+}
+
+std::shared_ptr<VoteSnapshot> VoteManager::buildSnapshot(const VoteSnapshot* base) const {
+    auto view = std::make_shared<VoteSnapshot>();
+    view->version = tallyVersion + (sharded ? sharded->tally.epoch() : 0);
+    
+    // Running candidate totals can be patched row by row only if the base
+    // snapshot has the same candidates; otherwise sum every row
+    bool patchTotals = base && base->candidateTotals.size() == candidates.size();
+    view->candidateTotals = patchTotals ? base->candidateTotals : std::vector<int64_t>(candidates.size(), 0);
+    
+    std::vector<int64_t> row;
+    for (DistrictHandle handle = 0; handle < districts.size(); ++handle) {
+        bool clean = base && handle < base->districtRows.size() && !dirtyDistricts[handle];
+        if (clean) {
+            view->districtRows.push_back(base->districtRows[handle]);
+            view->districtTotals.push_back(base->districtTotals[handle]);
+            view->districtLeaders.push_back(base->districtLeaders[handle]);
+            if (!patchTotals) {
+                const auto& votes = *base->districtRows[handle];
+                for (CandidateHandle candidate = 0; candidate < votes.size(); ++candidate) {
+                    view->candidateTotals[candidate] += votes[candidate];
+                }
+            }
+            continue;
+        }
+        
+        // Derive the row, its total and its leader from one read so they agree
+        tallies->readDistrict(handle, row);
+        if (sharded) {
+            sharded->tally.accumulateDistrict(handle, row);
+        }
+        const auto& assigned = slotCandidates[handle];
+        size_t active = std::min(assigned.size(), row.size());
+        auto votes = std::make_shared<std::vector<int64_t>>(candidates.size(), 0);
+        for (size_t slot = 0; slot < active; ++slot) {
+            (*votes)[assigned[slot]] = row[slot];
+        }
+        
+        if (patchTotals && handle < base->districtRows.size()) {
+            const auto& previous = *base->districtRows[handle];
+            for (CandidateHandle candidate = 0; candidate < previous.size(); ++candidate) {
+                view->candidateTotals[candidate] -= previous[candidate];
+            }
+        }
+        for (CandidateHandle candidate = 0; candidate < votes->size(); ++candidate) {
+            view->candidateTotals[candidate] += (*votes)[candidate];
+        }
+        
+        view->districtRows.push_back(std::move(votes));
+        view->districtTotals.push_back(sumCounters(row.data(), row.size()));
+        view->districtLeaders.push_back(active == 0 ? kInvalidHandle
+                                                    : assigned[argmaxCounters(row.data(), active)]);
+    }
+    
+    view->overallLeader = candidates.empty() ? kInvalidHandle
+        : static_cast<CandidateHandle>(argmaxCounters(view->candidateTotals.data(), candidates.size()));
+    return view;
+}
+
+std::shared_ptr<const VoteSnapshot> VoteManager::snapshot() const {
+    return std::atomic_load(&publishedSnapshot);
+}
+
+std::shared_ptr<const VoteSnapshot> VoteManager::publishSnapshot() {
+    std::shared_ptr<const VoteSnapshot> current = std::atomic_load(&publishedSnapshot);
+    
+    // Shard writes are not tracked per district, so any of them dirties every row
+    uint64_t shardEpoch = sharded ? sharded->tally.epoch() : 0;
+    if (shardEpoch != publishedShardEpoch) {
+        allDistrictsDirty = true;
+    }
+    bool dirty = allDistrictsDirty ||
+        std::find(dirtyDistricts.begin(), dirtyDistricts.end(), true) != dirtyDistricts.end();
+    if (!dirty) {
+        return current;
+    }
+    
+    std::shared_ptr<const VoteSnapshot> next = buildSnapshot(allDistrictsDirty ? nullptr : current.get());
+    std::atomic_store(&publishedSnapshot, next);
+    publishedShardEpoch = shardEpoch;
+    std::fill(dirtyDistricts.begin(), dirtyDistricts.end(), false);
+    allDistrictsDirty = false;
+    return next;
 }
 
     string VoteManager::getDetailedResults() const {
+    return getDetailedResults(*buildSnapshot(nullptr));
+}
+
+    string VoteManager::getDetailedResults(const VoteSnapshot& view) const {
     std::ostringstream oss;
     oss << "=== ELECTION RESULTS ===\n\n";
     
     // Overall results
-    std::string overallLeader = getOverallLeader();
-    if (!overallLeader.empty()) {
-        auto leaderIt = std::find_if(candidates.begin(), candidates.end(),
-            [&overallLeader](const Candidate& c) { return c.id == overallLeader; });
-        if (leaderIt != candidates.end()) {
-            int64_t totalVotes = getCandidateTotalVotes(overallLeader);
-            oss << "OVERALL LEADER: " << leaderIt->name << " (" << leaderIt->party << ") - " 
-                << totalVotes << " votes\n\n";
-        }
+    CandidateHandle overallLeader = view.getOverallLeader();
+    if (overallLeader != kInvalidHandle) {
+        const auto& leader = candidates[overallLeader];
+        oss << "OVERALL LEADER: " << leader.name << " (" << leader.party << ") - " 
+            << view.getCandidateTotalVotes(overallLeader) << " votes\n\n";
     }
     
     // Results by district
-    for (const auto& district : districts) {
+    for (DistrictHandle handle = 0; handle < view.getDistrictCount(); ++handle) {
+        const auto& district = districts[handle];
         oss << "DISTRICT: " << district.name << " (" << district.id << ")\n";
         oss << std::string(40, '-') << "\n";
         
-        // Get all candidates in this district with their vote counts
-        std::vector<std::pair<std::string, int64_t>> districtResults;
-        for (const auto& candidate : candidates) {
-            int64_t votes = getCandidateVotes(district.id, candidate.id);
-            if (votes > 0) {
-                districtResults.emplace_back(candidate.id, votes);
+        const std::vector<int64_t>& votes = view.getDistrictVotes(handle);
+        std::vector<std::pair<CandidateHandle, int64_t>> districtResults;
+        for (CandidateHandle candidate = 0; candidate < votes.size(); ++candidate) {
+            if (votes[candidate] > 0) {
+                districtResults.emplace_back(candidate, votes[candidate]);
             }
         }
         
@@ -191,15 +1079,12 @@ void VoteManager::resetVotes() {
             [](const auto& a, const auto& b) { return a.second > b.second; });
         
         for (const auto& result : districtResults) {
-            auto candidateIt = std::find_if(candidates.begin(), candidates.end(),
-                [&result](const Candidate& c) { return c.id == result.first; });
-            if (candidateIt != candidates.end()) {
-                oss << std::setw(20) << std::left << candidateIt->name
-                    << " (" << candidateIt->party << "): " << result.second << " votes\n";
-            }
+            const auto& candidate = candidates[result.first];
+            oss << std::setw(20) << std::left << candidate.name
+                << " (" << candidate.party << "): " << result.second << " votes\n";
         }
         
-        int64_t districtTotal = getDistrictTotalVotes(district.id);
+        int64_t districtTotal = view.getDistrictTotalVotes(handle);
         oss << std::string(40, '-') << "\n";
         oss << "TOTAL DISTRICT VOTES: " << districtTotal << "\n\n";
     }
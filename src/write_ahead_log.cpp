@@ -0,0 +1,428 @@
+#include "write_ahead_log.hpp"
+#include "binary_file.hpp"
+#include <stdexcept>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+constexpr size_t kFrameHeader = 8;  // u32 length + u32 CRC32C
+
+#if !defined(__SSE4_2__)
+struct Crc32cTable {
+    uint32_t entries[256];
+
+    Crc32cTable() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u)));
+            }
+            entries[i] = crc;
+        }
+    }
+};
+#endif
+
+} // namespace
+
+uint32_t crc32c(const void* data, size_t length, uint32_t crc) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+
+#if defined(__SSE4_2__)
+    uint64_t wide = crc;
+    for (; length >= 8; length -= 8, bytes += 8) {
+        wide = _mm_crc32_u64(wide, getU64(bytes));
+    }
+    crc = static_cast<uint32_t>(wide);
+    for (; length > 0; --length, ++bytes) {
+        crc = _mm_crc32_u8(crc, *bytes);
+    }
+#else
+    static const Crc32cTable table;
+    for (; length > 0; --length, ++bytes) {
+        crc = table.entries[(crc ^ *bytes) & 0xFF] ^ (crc >> 8);
+    }
+#endif
+
+    return ~crc;
+}
+
+WriteAheadLog::WriteAheadLog(const std::string& path, WalOptions options)
+    : path(path), options(options) {
+    // Continue an existing log after its last intact record
+    WalReadResult existing = read(path, [](const WalRecord&) {});
+    lastSequence = existing.lastSequence;
+    durableSequence = existing.lastSequence;
+
+    fd = openAppendFile(path);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open write-ahead log: " + path);
+    }
+    if (existing.tornTail && !truncateFile(fd, existing.validBytes)) {
+        closeFile(fd);
+        throw std::runtime_error("Cannot truncate torn write-ahead log tail: " + path);
+    }
+
+    flusher = std::thread(&WriteAheadLog::flushLoop, this);
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    flushNeeded.notify_one();
+    flusher.join();
+    closeFile(fd);
+}
+
+size_t WriteAheadLog::beginFrame() {
+    size_t start = pending.size();
+    pending.resize(start + kFrameHeader);
+    return start;
+}
+
+void WriteAheadLog::endFrame(size_t start) {
+    const unsigned char* payload = pending.data() + start + kFrameHeader;
+    size_t length = pending.size() - start - kFrameHeader;
+    uint32_t checksum = crc32c(payload, length);
+    for (int i = 0; i < 4; ++i) {
+        pending[start + i] = static_cast<unsigned char>(length >> (8 * i));
+        pending[start + 4 + i] = static_cast<unsigned char>(checksum >> (8 * i));
+    }
+}
+
+uint32_t WriteAheadLog::define(std::unordered_map<std::string, uint32_t>& table, DefinitionType type,
+                               const std::string& text) {
+    auto it = table.find(text);
+    if (it != table.end()) {
+        return it->second;
+    }
+
+    uint32_t id = static_cast<uint32_t>(table.size());
+    table.emplace(text, id);
+
+    size_t start = beginFrame();
+    pending.push_back(static_cast<unsigned char>(type));
+    putU32(pending, id);
+    putU32(pending, static_cast<uint32_t>(text.size()));
+    pending.insert(pending.end(), text.begin(), text.end());
+    endFrame(start);
+    return id;
+}
+
+uint64_t WriteAheadLog::appendVote(uint32_t district, uint32_t candidate, int64_t delta,
+                                   const std::string& precinctId, int64_t timestampNs,
+                                   const std::string& timestampLabel) {
+    bool wake;
+    uint64_t sequence;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (failed) {
+            throw std::runtime_error("Write-ahead log write failed: " + path);
+        }
+
+        uint32_t precinct = define(precinctIds, DefinitionType::Precinct, precinctId);
+        bool labelled = !timestampLabel.empty();
+        int64_t timestamp = labelled
+            ? define(timestampLabels, DefinitionType::TimestampLabel, timestampLabel)
+            : timestampNs;
+
+        // Encode straight into the pending buffer: no allocation per record
+        sequence = ++lastSequence;
+        size_t start = beginFrame();
+        pending.push_back(static_cast<unsigned char>(WalRecord::Type::Vote));
+        putU64(pending, sequence);
+        putU32(pending, district);
+        putU32(pending, candidate);
+        putU32(pending, precinct);
+        pending.push_back(labelled ? 1 : 0);
+        putU64(pending, static_cast<uint64_t>(timestamp));
+        putU64(pending, static_cast<uint64_t>(delta));
+        endFrame(start);
+
+        wake = pending.size() >= options.maxBatchBytes;
+    }
+    if (wake) {
+        flushNeeded.notify_one();
+    }
+    return sequence;
+}
+
+uint64_t WriteAheadLog::appendBatch(uint32_t district, const std::vector<WalBatchEntry>& entries,
+                                    int64_t timestampNs, const std::string& timestampLabel) {
+    bool wake;
+    uint64_t sequence;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (failed) {
+            throw std::runtime_error("Write-ahead log write failed: " + path);
+        }
+
+        // Definitions go first, outside the batch frame
+        std::vector<uint32_t> precincts;
+        precincts.reserve(entries.size());
+        for (const WalBatchEntry& entry : entries) {
+            precincts.push_back(define(precinctIds, DefinitionType::Precinct, entry.precinctId));
+        }
+        bool labelled = !timestampLabel.empty();
+        int64_t timestamp = labelled
+            ? define(timestampLabels, DefinitionType::TimestampLabel, timestampLabel)
+            : timestampNs;
+
+        sequence = ++lastSequence;
+        size_t start = beginFrame();
+        pending.push_back(static_cast<unsigned char>(WalRecord::Type::Batch));
+        putU64(pending, sequence);
+        putU32(pending, district);
+        pending.push_back(labelled ? 1 : 0);
+        putU64(pending, static_cast<uint64_t>(timestamp));
+        putU32(pending, static_cast<uint32_t>(entries.size()));
+        for (size_t i = 0; i < entries.size(); ++i) {
+            putU32(pending, entries[i].candidate);
+            putU32(pending, precincts[i]);
+            putU64(pending, static_cast<uint64_t>(entries[i].delta));
+        }
+        endFrame(start);
+
+        wake = pending.size() >= options.maxBatchBytes;
+    }
+    if (wake) {
+        flushNeeded.notify_one();
+    }
+    return sequence;
+}
+
+uint64_t WriteAheadLog::appendPrecinct(uint32_t district, const std::string& precinctId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (failed) {
+        throw std::runtime_error("Write-ahead log write failed: " + path);
+    }
+
+    uint32_t precinct = define(precinctIds, DefinitionType::Precinct, precinctId);
+    size_t start = beginFrame();
+    pending.push_back(static_cast<unsigned char>(WalRecord::Type::Precinct));
+    putU64(pending, ++lastSequence);
+    putU32(pending, district);
+    putU32(pending, precinct);
+    endFrame(start);
+    return lastSequence;
+}
+
+uint64_t WriteAheadLog::appendReset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (failed) {
+        throw std::runtime_error("Write-ahead log write failed: " + path);
+    }
+
+    size_t start = beginFrame();
+    pending.push_back(static_cast<unsigned char>(WalRecord::Type::Reset));
+    putU64(pending, ++lastSequence);
+    endFrame(start);
+    return lastSequence;
+}
+
+void WriteAheadLog::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    uint64_t target = lastSequence;
+    flushRequested = true;
+    flushNeeded.notify_one();
+    durableChanged.wait(lock, [&]() { return durableSequence >= target || failed; });
+    if (failed) {
+        throw std::runtime_error("Write-ahead log write failed: " + path);
+    }
+}
+
+void WriteAheadLog::waitDurable(uint64_t sequence) {
+    std::unique_lock<std::mutex> lock(mutex);
+    durableChanged.wait(lock, [&]() { return durableSequence >= sequence || failed; });
+    if (failed) {
+        throw std::runtime_error("Write-ahead log write failed: " + path);
+    }
+}
+
+uint64_t WriteAheadLog::getLastSequence() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lastSequence;
+}
+
+uint64_t WriteAheadLog::getDurableSequence() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return durableSequence;
+}
+
+uint64_t WriteAheadLog::getSyncCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return syncCount;
+}
+
+void WriteAheadLog::flushLoop() {
+    std::vector<unsigned char> writing;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        flushNeeded.wait_for(lock, options.flushWindow, [&]() {
+            return stopping || flushRequested || pending.size() >= options.maxBatchBytes;
+        });
+        flushRequested = false;
+
+        if (!pending.empty() && !failed) {
+            // Take the whole group and do the I/O without holding the lock
+            writing.swap(pending);
+            uint64_t groupSequence = lastSequence;
+            lock.unlock();
+            bool ok = writeFully(fd, writing.data(), writing.size()) &&
+                      (!options.syncToDisk || syncFile(fd));
+            writing.clear();
+            lock.lock();
+
+            if (ok) {
+                durableSequence = groupSequence;
+                ++syncCount;
+            } else {
+                failed = true;
+            }
+        } else if (pending.empty()) {
+            // Nothing buffered: a flush() of already-durable records completes now
+            durableSequence = lastSequence;
+        }
+        durableChanged.notify_all();
+
+        if (stopping && (pending.empty() || failed)) {
+            break;
+        }
+    }
+}
+
+WalReadResult WriteAheadLog::read(const std::string& path, const std::function<void(const WalRecord&)>& visit) {
+    WalReadResult result;
+    std::vector<unsigned char> bytes;
+    if (!readFile(path, bytes)) {
+        return result;
+    }
+
+    std::unordered_map<uint32_t, std::string> precincts;
+    std::unordered_map<uint32_t, std::string> labels;
+    size_t offset = 0;
+    while (offset < bytes.size()) {
+        if (bytes.size() - offset < kFrameHeader) {
+            break;
+        }
+        uint32_t length = getU32(&bytes[offset]);
+        uint32_t checksum = getU32(&bytes[offset + 4]);
+        if (length == 0 || length > bytes.size() - offset - kFrameHeader) {
+            break;
+        }
+        const unsigned char* payload = &bytes[offset + kFrameHeader];
+        if (crc32c(payload, length) != checksum) {
+            break;
+        }
+
+        uint8_t type = payload[0];
+        if (type == static_cast<uint8_t>(DefinitionType::Precinct) ||
+            type == static_cast<uint8_t>(DefinitionType::TimestampLabel)) {
+            if (length < 9 || getU32(payload + 5) != length - 9) {
+                break;
+            }
+            auto& table = type == static_cast<uint8_t>(DefinitionType::Precinct) ? precincts : labels;
+            table[getU32(payload + 1)] = std::string(reinterpret_cast<const char*>(payload + 9), length - 9);
+        } else if (type == static_cast<uint8_t>(WalRecord::Type::Vote) && length == 38) {
+            WalRecord record;
+            record.type = WalRecord::Type::Vote;
+            record.sequence = getU64(payload + 1);
+            record.district = getU32(payload + 9);
+            record.candidate = getU32(payload + 13);
+            uint32_t precinct = getU32(payload + 17);
+            bool labelled = payload[21] != 0;
+            int64_t timestamp = static_cast<int64_t>(getU64(payload + 22));
+            record.delta = static_cast<int64_t>(getU64(payload + 30));
+
+            auto precinctIt = precincts.find(precinct);
+            if (precinctIt == precincts.end()) {
+                break;
+            }
+            record.precinctId = precinctIt->second;
+            if (labelled) {
+                auto labelIt = labels.find(static_cast<uint32_t>(timestamp));
+                if (labelIt == labels.end()) {
+                    break;
+                }
+                record.timestampLabel = labelIt->second;
+            } else {
+                record.timestampNs = timestamp;
+            }
+
+            visit(record);
+            ++result.records;
+            result.lastSequence = record.sequence;
+        } else if (type == static_cast<uint8_t>(WalRecord::Type::Batch) && length >= 26 &&
+                   (length - 26) % 16 == 0 && getU32(payload + 22) == (length - 26) / 16) {
+            WalRecord record;
+            record.type = WalRecord::Type::Batch;
+            record.sequence = getU64(payload + 1);
+            record.district = getU32(payload + 9);
+            bool labelled = payload[13] != 0;
+            int64_t timestamp = static_cast<int64_t>(getU64(payload + 14));
+            if (labelled) {
+                auto labelIt = labels.find(static_cast<uint32_t>(timestamp));
+                if (labelIt == labels.end()) {
+                    break;
+                }
+                record.timestampLabel = labelIt->second;
+            } else {
+                record.timestampNs = timestamp;
+            }
+
+            bool known = true;
+            record.entries.resize(getU32(payload + 22));
+            for (size_t i = 0; i < record.entries.size() && known; ++i) {
+                const unsigned char* entry = payload + 26 + i * 16;
+                auto precinctIt = precincts.find(getU32(entry + 4));
+                known = precinctIt != precincts.end();
+                if (known) {
+                    record.entries[i] = {getU32(entry), static_cast<int64_t>(getU64(entry + 8)), precinctIt->second};
+                }
+            }
+            if (!known) {
+                break;
+            }
+
+            visit(record);
+            ++result.records;
+            result.lastSequence = record.sequence;
+        } else if (type == static_cast<uint8_t>(WalRecord::Type::Precinct) && length == 17) {
+            WalRecord record;
+            record.type = WalRecord::Type::Precinct;
+            record.sequence = getU64(payload + 1);
+            record.district = getU32(payload + 9);
+            auto precinctIt = precincts.find(getU32(payload + 13));
+            if (precinctIt == precincts.end()) {
+                break;
+            }
+            record.precinctId = precinctIt->second;
+            visit(record);
+            ++result.records;
+            result.lastSequence = record.sequence;
+        } else if (type == static_cast<uint8_t>(WalRecord::Type::Reset) && length == 9) {
+            WalRecord record;
+            record.type = WalRecord::Type::Reset;
+            record.sequence = getU64(payload + 1);
+            visit(record);
+            ++result.records;
+            result.lastSequence = record.sequence;
+        } else {
+            break;
+        }
+
+        offset += kFrameHeader + length;
+        result.validBytes = offset;
+    }
+
+    result.tornTail = result.validBytes < bytes.size();
+    return result;
+}
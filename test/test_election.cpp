@@ -1,6 +1,25 @@
 #include "../include/election_system.hpp"
+#include "../include/tally_kernels.hpp"
+#include "../include/concurrent_fenwick_tree.hpp"
+#include "../include/persistent_fenwick_tree.hpp"
 #include <iostream>
 #include <cassert>
+#include <random>
+#include <thread>
+#include <tuple>
+#include <atomic>
+#include <numeric>
+#include <limits>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <chrono>
+
+#ifndef _WIN32
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 void testBasicElection() {
     std::cout << "Testing basic election functionality...\n";
@@ -126,6 +145,1867 @@ void testPerformance() {
 }
 
 
+void testHandleApi() {
+    std::cout << "Testing handle-based VoteManager API...\n";
+    
+    VoteManager manager;
+    DistrictHandle north = manager.addDistrict(District("North", "D1", 2));
+    DistrictHandle south = manager.addDistrict(District("South", "D2", 2));
+    CandidateHandle alice = manager.addCandidate(Candidate("Alice", "Party A", "C1"));
+    CandidateHandle bob = manager.addCandidate(Candidate("Bob", "Party B", "C2"));
+    assert(north == 0 && south == 1);
+    assert(alice == 0 && bob == 1);
+    
+    manager.assignCandidateToDistrict(north, alice);
+    manager.assignCandidateToDistrict(north, bob);
+    manager.assignCandidateToDistrict("D2", "C2");
+    
+    assert(manager.getDistrictHandle("D2") == south);
+    assert(manager.getCandidateHandle("C1") == alice);
+    assert(manager.getDistrictHandle("D9") == kInvalidHandle);
+    
+    // Handle and string overloads update the same tallies
+    manager.addVotes(north, alice, 40, "P1", "t0");
+    manager.addVotes("D1", "C1", 2, "P2", "t1");
+    manager.addVotes(north, bob, 10, "P1", "t2");
+    manager.addVotes(south, bob, 7, "P3", "t3");
+    assert(manager.getCandidateVotes(north, alice) == 42);
+    assert(manager.getCandidateVotes("D1", "C2") == 10);
+    assert(manager.getDistrictTotalVotes(north) == 52);
+    assert((manager.getDistrictVotes(north) == std::vector<int64_t>{42, 10}));
+    assert(manager.getDistrictTotalVotes("D2") == 7);
+    assert(manager.getCandidateTotalVotes("C2") == 17);
+    assert(manager.getCandidateTotalVotes(alice) == 42);
+    assert(manager.getOverallLeader() == "C1");
+    assert(manager.getVoteHistory().back().districtId == "D2");
+    
+    // Alice is not on the ballot in the south district
+    bool threw = false;
+    try {
+        manager.addVotes(south, alice, 1, "P3", "t4");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    assert(manager.getCandidateVotes(south, alice) == 0);
+    assert(manager.getCandidateTotalVotes(alice) == 42);
+    
+    // The try path reports the same failures as statuses and changes nothing
+    size_t historyBefore = manager.getVoteHistory().size();
+    assert(manager.tryAddVotes(south, alice, 1, "P3", 0) == VoteStatus::CandidateNotInDistrict);
+    assert(manager.tryAddVotes(9, alice, 1, "P3", 0) == VoteStatus::UnknownDistrict);
+    assert(manager.tryAddVotes(north, 9, 1, "P3", 0) == VoteStatus::UnknownCandidate);
+    assert(manager.tryAddVotes("D9", "C1", 1, "P3", 0) == VoteStatus::UnknownDistrict);
+    assert(manager.tryAddVotes("D1", "C9", 1, "P3", 0) == VoteStatus::UnknownCandidate);
+    assert(manager.tryAddVotesBatch(south, {{bob, 5}, {alice, 1}}, "P3", 0) ==
+           VoteStatus::CandidateNotInDistrict);
+    assert(manager.getVoteHistory().size() == historyBefore);
+    assert(manager.getDistrictTotalVotes(south) == 7);
+    assert(manager.tryAddVotes("D1", "C2", 3, "P2", 0) == VoteStatus::Ok);
+    assert(manager.tryAddVotesBatch(south, {{bob, 5}}, "P3", 0) == VoteStatus::Ok);
+    assert(manager.getCandidateTotalVotes(bob) == 25);
+    
+    // A third candidate assigned past the district's two slots is rejected
+    CandidateHandle carol = manager.addCandidate(Candidate("Carol", "Party C", "C3"));
+    manager.assignCandidateToDistrict(north, carol);
+    assert(manager.tryAddVotes(north, carol, 1, "P1", 0) == VoteStatus::DistrictFull);
+    threw = false;
+    try {
+        manager.addVotes(north, carol, 1, "P1", int64_t(0));
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    assert(threw);
+    
+    // National totals follow corrections and resets
+    manager.addVotes(south, bob, 30, "P3", "t5");
+    assert(manager.getCandidateTotalVotes(bob) == 55);
+    assert(manager.getOverallLeader() == "C2");
+    manager.resetVotes();
+    assert(manager.getCandidateTotalVotes(bob) == 0);
+    
+    std::cout << "✓ Handle API tests passed!\n\n";
+}
+
+void testTallyStorageBackends() {
+    std::cout << "Testing tally storage backends...\n";
+    
+    const TallyStorage backends[] = {
+        TallyStorage::Adaptive,
+        TallyStorage::DistrictTrees,
+        TallyStorage::FixedDistrictTrees,
+        TallyStorage::DistrictMajorMatrix,
+        TallyStorage::CandidateMajorMatrix
+    };
+    
+    std::vector<std::string> results;
+    for (TallyStorage storage : backends) {
+        VoteManager manager(storage);
+        assert(manager.getTallyStorage() == storage);
+        
+        // Enough districts to force the matrix to grow, with uneven widths
+        for (int d = 0; d < 20; ++d) {
+            manager.addDistrict(District("District " + std::to_string(d), "D" + std::to_string(d), 1 + d % 5));
+        }
+        for (int c = 0; c < 5; ++c) {
+            manager.addCandidate(Candidate("Candidate " + std::to_string(c), "Party", "C" + std::to_string(c)));
+        }
+        for (DistrictHandle d = 0; d < 20; ++d) {
+            for (CandidateHandle c = 0; c <= d % 5; ++c) {
+                manager.assignCandidateToDistrict(d, c);
+            }
+        }
+        
+        for (DistrictHandle d = 0; d < 20; ++d) {
+            for (CandidateHandle c = 0; c <= d % 5; ++c) {
+                manager.addVotes(d, c, 10 * d + c + 1, "P", "t");
+            }
+        }
+        manager.addVotes(7, 1, -5, "P", "t");
+        
+        assert(manager.getCandidateVotes(7, 1) == 10 * 7 + 2 - 5);
+        assert(manager.getDistrictTotalVotes(4) == 41 + 42 + 43 + 44 + 45);
+        assert(manager.getCandidateVotes(0, 3) == 0);
+        results.push_back(manager.getDetailedResults());
+        
+        manager.resetVotes();
+        assert(manager.getDistrictTotalVotes(19) == 0);
+    }
+    
+    assert(results[0] == results[1]);
+    assert(results[0] == results[2]);
+    assert(results[0] == results[3]);
+    assert(results[0] == results[4]);
+    
+    std::cout << "✓ Tally storage backend tests passed!\n\n";
+}
+
+void testLeaderTracking() {
+    std::cout << "Testing maintained leader tracking...\n";
+    
+    LeaderTracker tracker(5);
+    assert(tracker.leader() == LeaderTracker::npos);
+    tracker.activate(3);
+    tracker.activate(1);
+    assert(tracker.leader() == 1);  // Ties go to the lower index
+    tracker.add(3, 10);
+    assert(tracker.leader() == 3 && tracker.value(3) == 10);
+    tracker.append(11);
+    assert(tracker.size() == 6 && tracker.leader() == 5);
+    tracker.reset();
+    assert(tracker.leader() == 1 && tracker.value(5) == 0);
+    
+    // Compare against a brute-force scan under random updates, including corrections
+    VoteManager manager;
+    for (int d = 0; d < 6; ++d) {
+        manager.addDistrict(District("District " + std::to_string(d), "D" + std::to_string(d), 7));
+    }
+    for (int c = 0; c < 7; ++c) {
+        manager.addCandidate(Candidate("Candidate " + std::to_string(c), "Party", "C" + std::to_string(c)));
+    }
+    for (DistrictHandle d = 0; d < 6; ++d) {
+        for (CandidateHandle c = 0; c < 7; ++c) {
+            manager.assignCandidateToDistrict(d, c);
+        }
+    }
+    
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<> districtDist(0, 5);
+    std::uniform_int_distribution<> candidateDist(0, 6);
+    std::uniform_int_distribution<> voteDist(-20, 100);
+    for (int i = 0; i < 2000; ++i) {
+        DistrictHandle d = districtDist(gen);
+        manager.addVotes(d, static_cast<CandidateHandle>(candidateDist(gen)), voteDist(gen), "P", "t");
+        
+        CandidateHandle expected = 0;
+        for (CandidateHandle c = 1; c < 7; ++c) {
+            if (manager.getCandidateVotes(d, c) > manager.getCandidateVotes(d, expected)) {
+                expected = c;
+            }
+        }
+        assert(manager.getDistrictLeader(d) == expected);
+        
+        CandidateHandle expectedOverall = 0;
+        for (CandidateHandle c = 1; c < 7; ++c) {
+            if (manager.getCandidateTotalVotes(c) > manager.getCandidateTotalVotes(expectedOverall)) {
+                expectedOverall = c;
+            }
+        }
+        assert(manager.getOverallLeaderHandle() == expectedOverall);
+    }
+    assert(manager.getDistrictLeader("D0") == manager.getCandidates()[manager.getDistrictLeader(0)].id);
+    
+    std::cout << "✓ Leader tracking tests passed!\n\n";
+}
+
+void testBatchApply() {
+    std::cout << "Testing batched Fenwick updates...\n";
+    
+    // Sparse and dense batches must match one update per entry
+    FenwickTree single(37), sparse(37), dense(37);
+    std::vector<std::pair<size_t, int64_t>> entries;
+    std::vector<int64_t> deltas(37, 0);
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<> indexDist(1, 37);
+    std::uniform_int_distribution<> voteDist(-10, 50);
+    for (int i = 0; i < 60; ++i) {
+        size_t index = indexDist(gen);
+        int64_t delta = voteDist(gen);
+        single.update(index, delta);
+        entries.emplace_back(index, delta);
+        deltas[index - 1] += delta;
+    }
+    sparse.applyBatch(entries);
+    dense.applyDenseBatch(deltas);
+    for (size_t i = 1; i <= 37; ++i) {
+        assert(sparse.query(i) == single.query(i));
+        assert(dense.query(i) == single.query(i));
+    }
+    
+    // A small sparse batch takes the per-entry path
+    sparse.applyBatch({std::make_pair(size_t(5), int64_t(3))});
+    assert(sparse.getValue(5) == single.getValue(5) + 3);
+    
+    // An invalid index rejects the whole batch
+    bool threw = false;
+    try {
+        dense.applyBatch({{2, 100}, {38, 1}});
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    assert(threw);
+    assert(dense.getValue(2) == single.getValue(2));
+    
+    // VoteManager batches go through every storage backend
+    for (TallyStorage storage : {TallyStorage::DistrictTrees, TallyStorage::DistrictMajorMatrix}) {
+        VoteManager manager(storage);
+        DistrictHandle district = manager.addDistrict(District("North", "D1", 3));
+        DistrictHandle other = manager.addDistrict(District("South", "D2", 1));
+        CandidateHandle alice = manager.addCandidate(Candidate("Alice", "Party A", "C1"));
+        CandidateHandle bob = manager.addCandidate(Candidate("Bob", "Party B", "C2"));
+        manager.assignCandidateToDistrict(district, alice);
+        manager.assignCandidateToDistrict(district, bob);
+        manager.assignCandidateToDistrict(other, alice);
+        
+        manager.addVotesBatch(district, {{alice, 10}, {bob, 25}, {alice, 5}}, "P1", "t0");
+        assert(manager.getCandidateVotes(district, alice) == 15);
+        assert(manager.getCandidateVotes(district, bob) == 25);
+        assert(manager.getDistrictLeader(district) == bob);
+        assert(manager.getCandidateTotalVotes(alice) == 15);
+        assert(manager.getVoteHistory().size() == 3);
+        
+        threw = false;
+        try {
+            manager.addVotesBatch(other, {{alice, 1}, {bob, 1}}, "P2", "t1");
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+        assert(manager.getDistrictTotalVotes(other) == 0);
+        assert(manager.getVoteHistory().size() == 3);
+    }
+    
+    std::cout << "✓ Batch apply tests passed!\n\n";
+}
+
+void testBulkConstruction() {
+    std::cout << "Testing linear-time Fenwick construction and extraction...\n";
+    
+    std::vector<int64_t> values;
+    for (int i = 0; i < 45; ++i) {
+        values.push_back((i * 37) % 11 - 3);
+    }
+    
+    FenwickTree built = FenwickTree::fromValues(values);
+    FenwickTree incremental(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        incremental.update(i + 1, values[i]);
+    }
+    for (size_t i = 1; i <= values.size(); ++i) {
+        assert(built.query(i) == incremental.query(i));
+    }
+    assert(built.toValues() == values);
+    
+    // Stores can load and read back whole district rows
+    for (TallyStorage storage : {TallyStorage::DistrictTrees, TallyStorage::CandidateMajorMatrix}) {
+        auto store = makeTallyStore(storage);
+        store->addDistrict(3);
+        store->addDistrict(values.size());
+        store->loadDistrict(1, values);
+        store->update(1, 4, 100);
+        
+        std::vector<int64_t> row;
+        store->readDistrict(1, row);
+        std::vector<int64_t> expected = values;
+        expected[3] += 100;
+        assert(row == expected);
+        assert(store->getValue(1, 4) == expected[3]);
+        store->readDistrict(0, row);
+        assert(row == std::vector<int64_t>(3, 0));
+    }
+    
+    std::cout << "✓ Bulk construction tests passed!\n\n";
+}
+
+void testTemplatedFenwick() {
+    std::cout << "Testing Fenwick Tree counter and index types...\n";
+    
+    // 32-bit counters and indices: corrections wrap but still cancel out
+    BasicFenwickTree<uint32_t, uint32_t> precinct(10);
+    precinct.update(3, 500);
+    precinct.update(7, 250);
+    precinct.update(3, static_cast<uint32_t>(-20));
+    assert(precinct.getValue(3) == 480);
+    assert(precinct.query(10) == 730);
+    assert(precinct.rangeQuery(4, 10) == 250);
+    
+    auto rebuilt = BasicFenwickTree<uint32_t, uint32_t>::fromValues(precinct.toValues());
+    assert(rebuilt.query(7) == precinct.query(7));
+    
+    // A full 16-bit index range must not wrap around during updates
+    BasicFenwickTree<int32_t, uint16_t> wide(65535);
+    wide.update(1, 1);
+    wide.update(32768, 2);
+    wide.update(65535, 3);
+    assert(wide.query(65535) == 6);
+    assert(wide.getValue(32768) == 2);
+    auto wideCopy = BasicFenwickTree<int32_t, uint16_t>::fromValues(wide.toValues());
+    assert(wideCopy.query(65535) == 6);
+    
+    // The default alias keeps the original interface
+    FenwickTree national(4);
+    national.update(2, -5);
+    assert(national.query(4) == -5);
+    
+    std::cout << "✓ Templated Fenwick tests passed!\n\n";
+}
+
+constexpr int64_t fixedTreeSum() {
+    FixedFenwickTree<8> tree(8);
+    tree.update(3, 5);
+    tree.update(8, 2);
+    tree.update(3, -1);
+    return tree.query(8);
+}
+
+// Fixed trees are usable in constant expressions
+static_assert(fixedTreeSum() == 6, "FixedFenwickTree must evaluate at compile time");
+
+void testFixedFenwick() {
+    std::cout << "Testing fixed-capacity Fenwick Tree...\n";
+    
+    // Active size below capacity behaves like a FenwickTree of that size
+    FixedFenwickTree<16> fixed(11);
+    FenwickTree dynamic(11);
+    for (size_t i = 1; i <= 11; ++i) {
+        fixed.update(i, static_cast<int64_t>(i * i) - 20);
+        dynamic.update(i, static_cast<int64_t>(i * i) - 20);
+    }
+    for (size_t i = 1; i <= 11; ++i) {
+        assert(fixed.query(i) == dynamic.query(i));
+        assert(fixed.getValue(i) == dynamic.getValue(i));
+    }
+    assert(fixed.toValues() == dynamic.toValues());
+    assert(FixedFenwickTree<16>::fromValues(fixed.toValues()).query(11) == dynamic.query(11));
+    
+    fixed.applyDenseBatch({1, 1, 1});
+    assert(fixed.query(3) == dynamic.query(3) + 3);
+    
+    bool threw = false;
+    try {
+        FixedFenwickTree<4> tooSmall(5);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    
+    // The fixed backend rejects districts it cannot hold
+    VoteManager manager(TallyStorage::FixedDistrictTrees);
+    threw = false;
+    try {
+        manager.addDistrict(District("Huge", "D1", kFixedFenwickCapacity + 1));
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    assert(manager.getDistricts().empty());
+    
+    std::cout << "✓ Fixed Fenwick tests passed!\n\n";
+}
+
+void testSmallRaceKernels() {
+    std::cout << "Testing small-race counter kernels (sum " << counterSumIsa() << ", argmax "
+              << counterArgmaxIsa() << ")...\n";
+    
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<> voteDist(-50, 50);
+    for (size_t n = 1; n <= 40; ++n) {
+        std::vector<int64_t> values(n);
+        for (auto& v : values) {
+            v = voteDist(gen);
+        }
+        values[n / 2] = values[n - 1];  // Force ties now and then
+        
+        int64_t sum = 0;
+        size_t best = 0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += values[i];
+            if (values[i] > values[best]) {
+                best = i;
+            }
+        }
+        assert(sumCounters(values.data(), n) == sum);
+        assert(argmaxCounters(values.data(), n) == best);
+    }
+    assert(sumCounters(nullptr, 0) == 0);
+    
+    // Mixed representations: districts of up to 3 candidates are direct
+    AdaptiveTallyStore store(3);
+    store.addDistrict(3);
+    store.addDistrict(9);
+    assert(store.isDirect(0) && !store.isDirect(1));
+    store.update(0, 2, 5);
+    store.update(1, 7, 8);
+    store.applyDenseBatch(0, {1, 0, 4});
+    assert(store.getValue(0, 3) == 4 && store.getDistrictTotal(0) == 10);
+    assert(store.leadingSlot(0, 3) == 2 && store.leadingSlot(0, 1) == 1);
+    assert(store.leadingSlot(1, 9) == 7 && store.getDistrictTotal(1) == 8);
+    
+    // Direct-district leaders only consider assigned candidates
+    VoteManager manager;
+    DistrictHandle district = manager.addDistrict(District("North", "D1", 4));
+    CandidateHandle alice = manager.addCandidate(Candidate("Alice", "Party A", "C1"));
+    CandidateHandle bob = manager.addCandidate(Candidate("Bob", "Party B", "C2"));
+    assert(manager.getDistrictLeader(district) == kInvalidHandle);
+    manager.assignCandidateToDistrict(district, bob);
+    manager.assignCandidateToDistrict(district, alice);
+    manager.addVotes(district, alice, -3, "P1", "t0");
+    assert(manager.getDistrictLeader(district) == bob);
+    manager.addVotes(district, alice, 10, "P1", "t1");
+    assert(manager.getDistrictLeader("D1") == "C1");
+    
+    std::cout << "✓ Small-race kernel tests passed!\n\n";
+}
+
+void testConcurrentFenwick() {
+    std::cout << "Testing concurrent Fenwick Tree under contention...\n";
+    
+    const size_t size = 64;
+    const int writers = 8;
+    const int updatesPerWriter = 20000;
+    ConcurrentFenwickTree tree(size);
+    
+    // Each writer records what it added so the final state can be checked exactly
+    std::vector<std::vector<int64_t>> expected(writers, std::vector<int64_t>(size, 0));
+    std::atomic<bool> done(false);
+    std::atomic<int64_t> finishedTotal(0);
+    
+    // Readers check the documented bounds while writers run (all deltas positive)
+    std::thread reader([&]() {
+        while (!done.load(std::memory_order_acquire)) {
+            int64_t floor = finishedTotal.load(std::memory_order_acquire);
+            int64_t seen = tree.query(size);
+            assert(seen >= floor);
+            assert(seen <= static_cast<int64_t>(writers) * updatesPerWriter * 10);
+        }
+    });
+    
+    std::vector<std::thread> threads;
+    for (int w = 0; w < writers; ++w) {
+        threads.emplace_back([&, w]() {
+            std::mt19937 gen(1000 + w);
+            std::uniform_int_distribution<size_t> indexDist(1, size);
+            std::uniform_int_distribution<int> voteDist(1, 10);
+            for (int i = 0; i < updatesPerWriter; ++i) {
+                size_t index = indexDist(gen);
+                int64_t delta = voteDist(gen);
+                tree.update(index, delta);
+                expected[w][index - 1] += delta;
+                finishedTotal.fetch_add(delta, std::memory_order_release);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+    
+    // Quiescent: every query must be exact
+    std::vector<int64_t> totals(size, 0);
+    for (const auto& perWriter : expected) {
+        for (size_t i = 0; i < size; ++i) {
+            totals[i] += perWriter[i];
+        }
+    }
+    assert(tree.toValues() == totals);
+    int64_t prefix = 0;
+    for (size_t i = 1; i <= size; ++i) {
+        prefix += totals[i - 1];
+        assert(tree.query(i) == prefix);
+        assert(tree.getValue(i) == totals[i - 1]);
+    }
+    assert(tree.query(size) == finishedTotal.load());
+    
+    std::cout << "✓ Concurrent Fenwick tests passed!\n\n";
+}
+
+void testShardedIngestion() {
+    std::cout << "Testing sharded multi-threaded ingestion...\n";
+    
+    // One small (direct) district and one large (tree-backed) district
+    const int shardCount = 4;
+    const int updatesPerShard = 20000;
+    VoteManager manager;
+    VoteManager reference;
+    for (VoteManager* m : {&manager, &reference}) {
+        m->addDistrict(District("Small", "D1", 3));
+        m->addDistrict(District("Large", "D2", 24));
+        for (int c = 0; c < 24; ++c) {
+            m->addCandidate(Candidate("Candidate " + std::to_string(c), "Party", "C" + std::to_string(c)));
+            m->assignCandidateToDistrict(1, c);
+            if (c < 3) {
+                m->assignCandidateToDistrict(0, c);
+            }
+        }
+        m->addVotes(0, 2, 5, "P0", "t0");
+    }
+    manager.enableSharding(shardCount);
+    assert(manager.getShardCount() == shardCount);
+    
+    // Readers merge the shards while writers run
+    std::atomic<bool> done(false);
+    std::thread reader([&]() {
+        while (!done.load(std::memory_order_acquire)) {
+            assert(manager.getOverallLeaderHandle() != kInvalidHandle);
+            assert(manager.getDistrictTotalVotes(DistrictHandle(1)) >= 0);
+        }
+    });
+    
+    std::vector<std::vector<std::tuple<DistrictHandle, CandidateHandle, int64_t>>> updates(shardCount);
+    std::vector<std::thread> writers;
+    for (int shard = 0; shard < shardCount; ++shard) {
+        writers.emplace_back([&, shard]() {
+            std::mt19937 gen(2000 + shard);
+            std::uniform_int_distribution<int> voteDist(1, 10);
+            for (int i = 0; i < updatesPerShard; ++i) {
+                DistrictHandle district = gen() % 2;
+                CandidateHandle candidate = gen() % (district == 0 ? 3 : 24);
+                int64_t delta = voteDist(gen);
+                manager.addVotesSharded(shard, district, candidate, delta);
+                updates[shard].emplace_back(district, candidate, delta);
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+    
+    for (const auto& perShard : updates) {
+        for (const auto& update : perShard) {
+            reference.addVotes(std::get<0>(update), std::get<1>(update), std::get<2>(update), "P1", "t1");
+        }
+    }
+    
+    // Once writers are joined the merged view matches single-threaded ingestion
+    assert(manager.getDetailedResults() == reference.getDetailedResults());
+    for (CandidateHandle c = 0; c < 24; ++c) {
+        assert(manager.getCandidateTotalVotes(c) == reference.getCandidateTotalVotes(c));
+    }
+    for (DistrictHandle d = 0; d < 2; ++d) {
+        assert(manager.getDistrictVotes(d) == reference.getDistrictVotes(d));
+        assert(manager.getDistrictLeader(d) == reference.getDistrictLeader(d));
+    }
+    assert(manager.getOverallLeaderHandle() == reference.getOverallLeaderHandle());
+    
+    // Main-path writes invalidate the cached totals as well
+    manager.addVotes(0, 1, 100000, "P2", "t2");
+    assert(manager.getOverallLeaderHandle() == 1);
+    assert(manager.getDistrictLeader(DistrictHandle(0)) == 1);
+    manager.resetVotes();
+    assert(manager.getCandidateTotalVotes(CandidateHandle(1)) == 0);
+    assert(manager.getDistrictTotalVotes(DistrictHandle(1)) == 0);
+    
+    std::cout << "✓ Sharded ingestion tests passed!\n\n";
+}
+
+void testBatchVoteUpdates() {
+    std::cout << "Testing batch processVoteUpdates...\n";
+    
+    std::vector<std::string> districts = {"North", "South"};
+    std::vector<std::string> candidates = {"Alice", "Bob", "Carol"};
+    std::vector<std::string> parties = {"A", "B", "C"};
+    ElectionSystem batched("Batch Test", "2024-01-01");
+    ElectionSystem looped("Loop Test", "2024-01-01");
+    batched.setupElection(districts, candidates, parties);
+    looped.setupElection(districts, candidates, parties);
+    
+    std::vector<VoteUpdateRequest> updates = {
+        {"North", "Alice", 10, "P1"},
+        {"South", "Bob", 7, "P9"},
+        {"North", "Bob", 4, "P1"},
+        {"Nowhere", "Alice", 1, "P1"},
+        {"North", "Nobody", 1, "P2"},
+        {"South", "Carol", 3, "P8"},
+        {"North", "Alice", 5, "P2"},
+    };
+    
+    // Nothing is applied while the election is inactive
+    std::vector<VoteStatus> closed = batched.processVoteUpdates(updates);
+    assert(closed.size() == updates.size() && closed[0] == VoteStatus::ElectionClosed);
+    batched.setElectionStatus(true);
+    looped.setElectionStatus(true);
+    
+    std::vector<VoteStatus> statuses = batched.processVoteUpdates(updates);
+    assert(statuses.size() == updates.size());
+    assert(statuses[3] == VoteStatus::UnknownDistrict);
+    assert(statuses[4] == VoteStatus::UnknownCandidate);
+    for (size_t i = 0; i < updates.size(); ++i) {
+        bool applied = looped.processVoteUpdate(updates[i].districtName, updates[i].candidateName,
+                                                updates[i].voteCount, updates[i].precinctId);
+        assert(applied == (statuses[i] == VoteStatus::Ok));
+    }
+    
+    // Same tallies and history as applying the updates one at a time
+    const VoteManager& a = *batched.getVoteManager();
+    const VoteManager& b = *looped.getVoteManager();
+    for (DistrictHandle d = 0; d < 2; ++d) {
+        assert(a.getDistrictVotes(d) == b.getDistrictVotes(d));
+    }
+    assert(a.getDistrictTotalVotes(DistrictHandle(0)) == 19);
+    assert(a.getCandidateTotalVotes(CandidateHandle(0)) == 15);
+    assert(a.getOverallLeader() == b.getOverallLeader());
+    std::vector<VoteUpdate> history = batched.getVoteHistory();
+    assert(history.size() == 5);
+    int64_t p1Votes = 0;
+    for (const VoteUpdate& update : history) {
+        assert(update.timestamp == history[0].timestamp);
+        if (update.precinctId == "P1") {
+            p1Votes += update.voteCount;
+        }
+    }
+    assert(p1Votes == 14);
+    
+    // simulateRandomUpdates goes through the batch path
+    batched.simulateRandomUpdates(1000);
+    assert(batched.getVoteHistory().size() == 1005);
+    
+#ifdef __linux__
+    // A failing log turns into per-item statuses rather than an exception
+    {
+        ElectionSystem failing("Full Disk", "2024-01-01");
+        failing.setupElection({"North"}, {"Alice"}, {"A"});
+        failing.setElectionStatus(true);
+        VoteManager* manager = const_cast<VoteManager*>(failing.getVoteManager());
+        manager->enableWriteAheadLog("/dev/full");
+        bool threw = false;
+        try {
+            manager->addVotes(0, 0, 1, "P0", int64_t(0));
+            manager->getWriteAheadLog()->flush();
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+        std::vector<VoteStatus> statuses = failing.processVoteUpdates({
+            {"North", "Alice", 3, "P1"},
+            {"North", "Nobody", 1, "P1"},
+        });
+        assert(statuses[0] == VoteStatus::StorageError);
+        assert(statuses[1] == VoteStatus::UnknownCandidate);
+    }
+#endif
+    
+    std::cout << "✓ Batch vote update tests passed!\n\n";
+}
+
+void testAsyncIngestion() {
+    std::cout << "Testing queued ingestion with an applier thread...\n";
+    
+    // The queue itself: FIFO, bounded, refuses pushes when full
+    MpscQueue<int> queue(3);
+    assert(queue.capacity() == 4);
+    for (int i = 0; i < 4; ++i) {
+        assert(queue.tryPush(int(i)));
+    }
+    assert(!queue.tryPush(99));
+    assert(queue.sizeApprox() == 4);
+    int value = -1;
+    assert(queue.tryPop(value) && value == 0);
+    assert(queue.tryPush(4));
+    for (int expected = 1; expected <= 4; ++expected) {
+        assert(queue.tryPop(value) && value == expected);
+    }
+    assert(!queue.tryPop(value));
+    
+    ElectionSystem election("Async Test", "2024-01-01");
+    std::vector<std::string> districts = {"North", "South", "East"};
+    std::vector<std::string> candidates = {"Alice", "Bob", "Carol"};
+    election.setupElection(districts, candidates, {"A", "B", "C"});
+    election.setElectionStatus(true);
+    
+    // Nothing is queued until the applier runs
+    assert(!election.submitVoteUpdate("North", "Alice", 1, "P0"));
+    election.startIngestion(1024);
+    assert(!election.submitVoteUpdate("Nowhere", "Alice", 1, "P0"));
+    
+    const int producers = 4;
+    const int updatesPerProducer = 5000;
+    std::vector<std::vector<int64_t>> expected(producers, std::vector<int64_t>(9, 0));
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p]() {
+            std::mt19937 gen(3000 + p);
+            for (int i = 0; i < updatesPerProducer; ++i) {
+                size_t d = gen() % 3;
+                size_t c = gen() % 3;
+                int64_t votes = 1 + gen() % 50;
+                std::string precinct = "P" + std::to_string(p * 10 + i % 5);
+                // Producers never block: a full queue is reported, so retry
+                while (!election.submitVoteUpdate(districts[d], candidates[c], votes, precinct)) {
+                    std::this_thread::yield();
+                }
+                expected[p][d * 3 + c] += votes;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    election.flushIngestion();
+    
+    IngestionStats stats = election.getIngestionStats();
+    assert(stats.submitted == static_cast<uint64_t>(producers * updatesPerProducer));
+    assert(stats.applied == stats.submitted);
+    assert(stats.failed == 0);
+    assert(stats.queueDepth == 0);
+    assert(stats.batches > 0 && stats.batches <= stats.applied);
+    assert(stats.maxQueueDepth <= 1024);
+    assert(stats.maxDrainLatencyNs >= stats.lastDrainLatencyNs);
+    
+    election.stopIngestion();
+    const VoteManager* manager = election.getVoteManager();
+    assert(manager->getVoteHistory().size() == stats.applied);
+    for (DistrictHandle d = 0; d < 3; ++d) {
+        for (CandidateHandle c = 0; c < 3; ++c) {
+            int64_t total = 0;
+            for (const auto& perProducer : expected) {
+                total += perProducer[d * 3 + c];
+            }
+            assert(manager->getCandidateVotes(d, c) == total);
+        }
+    }
+    assert(!election.submitVoteUpdate("North", "Alice", 1, "P0"));
+
+    // Producers racing with stop and restart: every accepted update is applied
+    int64_t before = manager->getCandidateTotalVotes(0);
+    std::atomic<bool> producing{true};
+    std::atomic<int64_t> accepted{0};
+    std::vector<std::thread> racers;
+    for (int p = 0; p < producers; ++p) {
+        racers.emplace_back([&]() {
+            while (producing.load()) {
+                if (election.submitVoteUpdate("North", "Alice", 1, "P9")) {
+                    accepted.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (int cycle = 0; cycle < 20; ++cycle) {
+        election.startIngestion(64);
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        election.flushIngestion();
+        election.stopIngestion();
+        assert(election.getIngestionStats().queueDepth == 0);
+    }
+    producing.store(false);
+    for (auto& thread : racers) {
+        thread.join();
+    }
+    stats = election.getIngestionStats();
+    assert(stats.applied + stats.failed == stats.submitted);
+    assert(manager->getCandidateTotalVotes(0) == before + accepted.load());
+
+    // A rejected update fails alone, not with the rest of its precinct
+    ElectionSystem mixed("Mixed Test", "2024-01-01");
+    mixed.setupElection({"North"}, {"Alice"}, {"A"});
+    mixed.setupElection({"South"}, {"Bob"}, {"B"});
+    mixed.setElectionStatus(true);
+    mixed.startIngestion(64);
+    assert(mixed.submitVoteUpdate("North", "Alice", 5, "P1"));
+    assert(mixed.submitVoteUpdate("North", "Bob", 7, "P1"));  // Bob is not on North's ballot
+    assert(mixed.submitVoteUpdate("North", "Alice", 2, "P1"));
+    assert(mixed.submitVoteUpdate("South", "Bob", 3, "P1"));
+    mixed.stopIngestion();
+    IngestionStats mixedStats = mixed.getIngestionStats();
+    assert(mixedStats.submitted == 4);
+    assert(mixedStats.applied == 3 && mixedStats.failed == 1);
+    assert(mixed.getVoteManager()->getCandidateVotes(0, 0) == 7);
+    assert(mixed.getVoteManager()->getCandidateVotes(1, 1) == 3);
+
+    std::cout << "✓ Async ingestion tests passed!\n\n";
+}
+
+void testSnapshots() {
+    std::cout << "Testing versioned result snapshots...\n";
+    
+    VoteManager manager;
+    for (int d = 0; d < 3; ++d) {
+        manager.addDistrict(District("District " + std::to_string(d), "D" + std::to_string(d), 20));
+    }
+    for (int c = 0; c < 20; ++c) {
+        manager.addCandidate(Candidate("Candidate " + std::to_string(c), "Party", "C" + std::to_string(c)));
+        for (DistrictHandle d = 0; d < 3; ++d) {
+            manager.assignCandidateToDistrict(d, c);
+        }
+    }
+    assert(manager.snapshot()->getVersion() == 0);
+    assert(manager.snapshot()->getDistrictCount() == 0);
+    
+    manager.addVotes(0, 3, 50, "P1", "t0");
+    manager.addVotes(1, 4, 70, "P2", "t1");
+    auto first = manager.publishSnapshot();
+    assert(manager.snapshot() == first);
+    assert(first->getCandidateVotes(0, 3) == 50);
+    assert(first->getDistrictTotalVotes(1) == 70);
+    assert(first->getCandidateTotalVotes(4) == 70);
+    assert(first->getOverallLeader() == 4);
+    assert(first->getDistrictLeader(2) == 0);
+    assert(manager.publishSnapshot() == first);
+    
+    // Later writes do not change a snapshot already handed out
+    manager.addVotes(0, 3, 40, "P1", "t2");
+    assert(first->getCandidateVotes(0, 3) == 50);
+    assert(first->getOverallLeader() == 4);
+    
+    auto second = manager.publishSnapshot();
+    assert(second->getVersion() > first->getVersion());
+    assert(second->getCandidateVotes(0, 3) == 90);
+    assert(second->getCandidateTotalVotes(3) == 90);
+    assert(second->getOverallLeader() == 3);
+    assert(second->getDistrictLeader(0) == 3);
+    // Untouched districts share their rows with the previous snapshot
+    assert(&second->getDistrictVotes(1) == &first->getDistrictVotes(1));
+    assert(&second->getDistrictVotes(0) != &first->getDistrictVotes(0));
+    assert(manager.getDetailedResults(*second) == manager.getDetailedResults());
+    
+    manager.resetVotes();
+    auto cleared = manager.publishSnapshot();
+    assert(cleared->getCandidateTotalVotes(3) == 0);
+    assert(second->getCandidateTotalVotes(3) == 90);
+    
+    // Readers always see internally consistent totals while the applier runs
+    ElectionSystem election("Snapshot Test", "2024-01-01");
+    std::vector<std::string> districts = {"North", "South", "East", "West"};
+    std::vector<std::string> candidates = {"Alice", "Bob", "Carol"};
+    election.setupElection(districts, candidates, {"A", "B", "C"});
+    election.setElectionStatus(true);
+    election.startIngestion(4096);
+    
+    std::atomic<bool> done(false);
+    std::thread reader([&]() {
+        uint64_t lastVersion = 0;
+        while (!done.load(std::memory_order_acquire)) {
+            auto view = election.getSnapshot();
+            assert(view->getVersion() >= lastVersion);
+            lastVersion = view->getVersion();
+            int64_t byDistrict = 0;
+            int64_t byCandidate = 0;
+            for (DistrictHandle d = 0; d < view->getDistrictCount(); ++d) {
+                int64_t row = 0;
+                for (int64_t votes : view->getDistrictVotes(d)) {
+                    row += votes;
+                }
+                assert(row == view->getDistrictTotalVotes(d));
+                byDistrict += row;
+            }
+            for (CandidateHandle c = 0; c < candidates.size(); ++c) {
+                byCandidate += view->getCandidateTotalVotes(c);
+            }
+            assert(byDistrict == byCandidate);
+        }
+    });
+    
+    std::mt19937 gen(4242);
+    int64_t expected = 0;
+    for (int i = 0; i < 20000; ++i) {
+        int64_t votes = 1 + gen() % 20;
+        while (!election.submitVoteUpdate(districts[gen() % 4], candidates[gen() % 3], votes, "P1")) {
+            std::this_thread::yield();
+        }
+        expected += votes;
+    }
+    election.flushIngestion();
+    done.store(true, std::memory_order_release);
+    reader.join();
+    
+    auto latest = election.getSnapshot();
+    int64_t total = 0;
+    for (CandidateHandle c = 0; c < candidates.size(); ++c) {
+        total += latest->getCandidateTotalVotes(c);
+    }
+    assert(total == expected);
+    
+    std::cout << "✓ Snapshot tests passed!\n\n";
+}
+
+void testPrecinctReports() {
+    std::cout << "Testing atomic precinct reports...\n";
+    
+    VoteManager manager;
+    DistrictHandle north = manager.addDistrict(District("North", "D1", 3));
+    std::vector<CandidateHandle> handles;
+    for (int c = 0; c < 3; ++c) {
+        std::string id = "C" + std::to_string(c + 1);
+        handles.push_back(manager.addCandidate(Candidate(id, "Party", id)));
+        manager.assignCandidateToDistrict(north, handles.back());
+    }
+    CandidateHandle outsider = manager.addCandidate(Candidate("Dave", "Party D", "C4"));
+    
+    // A bad entry rejects the whole report
+    uint64_t versionBefore = manager.publishSnapshot()->getVersion();
+    assert(manager.applyPrecinctReport(north, "P0", {{handles[0], 5}, {outsider, 1}}, 0) ==
+           VoteStatus::CandidateNotInDistrict);
+    assert(manager.getDistrictTotalVotes(north) == 0);
+    assert(manager.snapshot()->getVersion() == versionBefore);
+    
+    // Each report adds 1, 2 and 3 votes; a reader must only ever see whole reports
+    const int reports = 2000;
+    std::atomic<bool> done(false);
+    std::thread reader([&]() {
+        uint64_t lastVersion = 0;
+        while (!done.load(std::memory_order_acquire)) {
+            auto view = manager.snapshot();
+            int64_t first = view->getCandidateVotes(north, handles[0]);
+            assert(view->getCandidateVotes(north, handles[1]) == 2 * first);
+            assert(view->getCandidateVotes(north, handles[2]) == 3 * first);
+            assert(view->getDistrictTotalVotes(north) == 6 * first);
+            assert(view->getVersion() >= lastVersion);
+            lastVersion = view->getVersion();
+        }
+    });
+    for (int r = 0; r < reports; ++r) {
+        std::string precinct = "P" + std::to_string(r);
+        VoteStatus status = manager.applyPrecinctReport(
+            north, precinct, {{handles[0], 1}, {handles[1], 2}, {handles[2], 3}}, r);
+        assert(status == VoteStatus::Ok);
+        // Reports do not publish; the writer does, between reports
+        if (r % 16 == 0) {
+            manager.publishSnapshot();
+        }
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+    assert(manager.snapshot()->getVersion() < versionBefore + reports);
+    
+    // One version per report
+    auto last = manager.publishSnapshot();
+    assert(last->getVersion() == versionBefore + reports);
+    assert(last->getDistrictTotalVotes(north) == 6 * reports);
+    assert(manager.getVoteHistory().size() == 3 * static_cast<size_t>(reports));
+    
+    // ElectionSystem resolves names and applies the report the same way
+    ElectionSystem election("Report Test", "2024-11-05");
+    election.setupElection({"North"}, {"Alice", "Bob"}, {"A", "B"});
+    assert(election.processPrecinctReport("North", "P1", {{"Alice", 3}}) == VoteStatus::ElectionClosed);
+    election.setElectionStatus(true);
+    assert(election.processPrecinctReport("North", "P1", {{"Alice", 3}, {"Nobody", 1}}) ==
+           VoteStatus::UnknownCandidate);
+    assert(election.processPrecinctReport("South", "P1", {{"Alice", 3}}) == VoteStatus::UnknownDistrict);
+    assert(election.processPrecinctReport("North", "P1", {{"Alice", 3}, {"Bob", 4}}) == VoteStatus::Ok);
+    assert(election.getSnapshot()->getDistrictTotalVotes(0) == 7);
+    assert(election.getVoteManager()->snapshot()->getDistrictTotalVotes(0) == 7);
+    
+    std::cout << "✓ Precinct report tests passed!\n\n";
+}
+
+void testPrecinctIndex() {
+    std::cout << "Testing precinct index...\n";
+    
+    VoteManager manager;
+    DistrictHandle north = manager.addDistrict(District("North", "D1", 2));
+    DistrictHandle south = manager.addDistrict(District("South", "D2", 2));
+    CandidateHandle alice = manager.addCandidate(Candidate("Alice", "Party A", "C1"));
+    CandidateHandle bob = manager.addCandidate(Candidate("Bob", "Party B", "C2"));
+    CandidateHandle carol = manager.addCandidate(Candidate("Carol", "Party C", "C3"));
+    manager.assignCandidateToDistrict(north, alice);
+    manager.assignCandidateToDistrict(north, bob);
+    manager.assignCandidateToDistrict(south, bob);
+    manager.assignCandidateToDistrict(south, carol);
+    
+    // Declared precincts count towards the total but not as reporting
+    std::vector<PrecinctHandle> declared;
+    for (int p = 0; p < 100; ++p) {
+        declared.push_back(manager.addPrecinct(north, "N" + std::to_string(p)));
+    }
+    assert(manager.addPrecinct(north, "N7") == declared[7]);
+    assert(manager.getPrecinctCount(north) == 100);
+    assert(manager.getReportedPrecinctCount(north) == 0);
+    
+    manager.addVotes(north, alice, 10, "N7", int64_t(0));
+    manager.addVotes(north, bob, 4, "N7", int64_t(0));
+    manager.addVotesBatch(north, {{alice, 2}, {bob, 3}}, "N70", 0);
+    manager.applyPrecinctReport(north, "N99", {{alice, 0}, {bob, 0}}, 0);
+    assert(manager.getReportedPrecinctCount(north) == 3);
+    assert(manager.isPrecinctReported(declared[7]) && !manager.isPrecinctReported(declared[8]));
+    assert(manager.isPrecinctReported(declared[99]));
+    assert(manager.getPrecinctVotes(declared[7], alice) == 10);
+    assert(manager.getPrecinctVotes(declared[7], bob) == 4);
+    assert(manager.getPrecinctVotes(declared[7], carol) == 0);
+    assert(manager.getPrecinctTotalVotes(declared[70]) == 5);
+    assert(manager.getPrecinctTotalVotes(declared[99]) == 0);
+    const std::vector<uint64_t>& bits = manager.getPrecinctIndex().getReportedBits(north);
+    assert(bits.size() == 2 && bits[0] == (uint64_t(1) << 7));
+    assert(bits[1] == ((uint64_t(1) << (70 - 64)) | (uint64_t(1) << (99 - 64))));
+    
+    // Undeclared precincts are added on first use; the same ID in two districts is two precincts
+    manager.addVotes(south, carol, 6, "N7", int64_t(0));
+    manager.addVotes(south, bob, 1, "S1", int64_t(0));
+    PrecinctHandle southN7 = manager.getPrecinctHandle(south, "N7");
+    assert(southN7 != PrecinctIndex::npos && southN7 != declared[7]);
+    assert(manager.getPrecinctHandle(north, "N7") == declared[7]);
+    assert(manager.getPrecinctHandle(north, "S1") == PrecinctIndex::npos);
+    assert(manager.getPrecinctHandle(north, "Nowhere") == PrecinctIndex::npos);
+    
+    // A failed lookup's npos is rejected, not read out of range
+    int rejected = 0;
+    auto expectOutOfRange = [&](auto query) {
+        try {
+            query();
+        } catch (const std::out_of_range&) {
+            ++rejected;
+        }
+    };
+    expectOutOfRange([&]() { manager.getPrecinctVotes(PrecinctIndex::npos, alice); });
+    expectOutOfRange([&]() { manager.getPrecinctTotalVotes(PrecinctIndex::npos); });
+    expectOutOfRange([&]() { manager.isPrecinctReported(PrecinctIndex::npos); });
+    expectOutOfRange([&]() { manager.getPrecinctCount(kInvalidHandle); });
+    expectOutOfRange([&]() { manager.getReportedPrecinctCount(kInvalidHandle); });
+    assert(rejected == 5);
+    assert(manager.getPrecinctVotes(southN7, carol) == 6);
+    assert(manager.getPrecinctTotalVotes(declared[7]) == 14);
+    assert(manager.getPrecinctCount(south) == 2 && manager.getReportedPrecinctCount(south) == 2);
+    
+    // Rejected votes touch no precinct
+    assert(manager.tryAddVotes(south, alice, 5, "S2", 0) == VoteStatus::CandidateNotInDistrict);
+    assert(manager.getPrecinctCount(south) == 2);
+    
+    // Per-precinct rows add up to the district tallies
+    int64_t sum = 0;
+    for (PrecinctHandle precinct : manager.getPrecinctIndex().getPrecincts(north)) {
+        sum += manager.getPrecinctTotalVotes(precinct);
+    }
+    assert(sum == manager.getDistrictTotalVotes(north));
+    
+    // The index is rebuilt on restore from a checkpoint
+    const std::string checkpointPath = "test_election_precincts.ckpt";
+    const std::string walPath = "test_election_precincts.wal";
+    std::remove(walPath.c_str());
+    manager.writeCheckpoint(checkpointPath);
+    {
+        VoteManager restored;
+        restored.restoreFromCheckpoint(checkpointPath, walPath);
+        PrecinctHandle n7 = restored.getPrecinctHandle(north, "N7");
+        assert(n7 != PrecinctIndex::npos);
+        assert(restored.getPrecinctVotes(n7, alice) == 10 && restored.getPrecinctTotalVotes(n7) == 14);
+        assert(restored.getReportedPrecinctCount(north) == 3);
+        assert(restored.getPrecinctVotes(restored.getPrecinctHandle(south, "N7"), carol) == 6);
+        
+        // Declared precincts that never reported survive, under the same handles
+        assert(restored.getPrecinctCount(north) == 100);
+        assert(restored.getPrecinctHandle(north, "N8") == declared[8]);
+        assert(!restored.isPrecinctReported(declared[8]));
+        assert(restored.getPrecinctHandle(south, "N7") == southN7);
+    }
+    std::remove(checkpointPath.c_str());
+    
+    // Declarations are logged too, so recovering from the log keeps them
+    {
+        VoteManager logged;
+        logged.addDistrict(District("North", "D1", 2));
+        logged.addCandidate(Candidate("Alice", "Party A", "C1"));
+        logged.assignCandidateToDistrict(0, 0);
+        logged.enableWriteAheadLog(walPath);
+        for (int p = 0; p < 10; ++p) {
+            logged.addPrecinct(0, "L" + std::to_string(p));
+        }
+        logged.addPrecinct(0, "L3");
+        logged.addVotes(0, 0, 4, "L3", int64_t(0));
+        assert(logged.getWriteAheadLog()->getLastSequence() == 11);
+    }
+    {
+        VoteManager recovered;
+        recovered.addDistrict(District("North", "D1", 2));
+        recovered.addCandidate(Candidate("Alice", "Party A", "C1"));
+        recovered.assignCandidateToDistrict(0, 0);
+        recovered.recoverFromLog(walPath);
+        assert(recovered.getPrecinctCount(0) == 10);
+        assert(recovered.getReportedPrecinctCount(0) == 1);
+        assert(recovered.getPrecinctHandle(0, "L9") == 9);
+        assert(recovered.getPrecinctTotalVotes(recovered.getPrecinctHandle(0, "L3")) == 4);
+    }
+    std::remove(walPath.c_str());
+    
+    // A reset zeroes the rows and the reporting state; precincts stay declared
+    manager.resetVotes();
+    assert(manager.getPrecinctCount(north) == 100);
+    assert(manager.getReportedPrecinctCount(north) == 0);
+    assert(manager.getPrecinctTotalVotes(declared[7]) == 0);
+    assert(!manager.isPrecinctReported(declared[7]));
+    
+    std::cout << "✓ Precinct index tests passed!\n\n";
+}
+
+void testPointInTimeQueries() {
+    std::cout << "Testing persistent Fenwick point-in-time queries...\n";
+    
+    // Replay random updates and check every version against a brute-force log
+    const size_t size = 37;
+    PersistentFenwickTree tree(size);
+    std::vector<std::vector<int64_t>> states(1, std::vector<int64_t>(size, 0));
+    std::mt19937 gen(515);
+    for (uint64_t version = 1; version <= 300; ++version) {
+        states.push_back(states.back());
+        for (int k = 0; k < 1 + static_cast<int>(gen() % 3); ++k) {
+            size_t index = 1 + gen() % size;
+            int64_t delta = static_cast<int64_t>(gen() % 21) - 5;
+            tree.update(index, delta, version);
+            states.back()[index - 1] += delta;
+        }
+    }
+    for (uint64_t version = 0; version < states.size(); version += 7) {
+        int64_t prefix = 0;
+        for (size_t i = 1; i <= size; ++i) {
+            prefix += states[version][i - 1];
+            assert(tree.queryAt(i, version) == prefix);
+        }
+        assert(tree.getValueAt(5, version) == states[version][4]);
+    }
+    
+    // Compaction bounds memory and keeps every version from the checkpoint on
+    size_t before = tree.getEntryCount();
+    tree.compact(250);
+    assert(tree.getEntryCount() < before);
+    assert(tree.getOldestVersion() == 250);
+    for (uint64_t version = 250; version < states.size(); ++version) {
+        assert(tree.getValueAt(11, version) == states[version][10]);
+        assert(tree.queryAt(size, version) == std::accumulate(states[version].begin(), states[version].end(), int64_t(0)));
+    }
+    bool threw = false;
+    try {
+        tree.queryAt(size, 100);
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    assert(threw);
+    
+    // VoteManager answers "results after update #N" without replaying history
+    VoteManager manager;
+    manager.addDistrict(District("North", "D1", 3));
+    manager.addDistrict(District("South", "D2", 40));
+    for (int c = 0; c < 3; ++c) {
+        manager.addCandidate(Candidate("Candidate " + std::to_string(c), "Party", "C" + std::to_string(c)));
+        manager.assignCandidateToDistrict(0, c);
+        manager.assignCandidateToDistrict(1, c);
+    }
+    manager.addVotes(0, 0, 10, "P1", "t0");
+    manager.enableVersionTracking();
+    uint64_t start = manager.getCurrentVersion();
+    assert(manager.getCandidateVotesAt(0, 0, start) == 10);
+    
+    manager.addVotes(0, 1, 5, "P1", "t1");
+    uint64_t afterFirst = manager.getCurrentVersion();
+    manager.addVotesBatch(1, {{2, 30}, {0, 4}}, "P2", "t2");
+    manager.addVotes(0, 1, 20, "P3", "t3");
+    uint64_t beforeReset = manager.getCurrentVersion();
+    manager.resetVotes();
+    manager.addVotes(1, 2, 1, "P4", "t4");
+    
+    assert(manager.getCandidateVotesAt(0, 1, start) == 0);
+    assert(manager.getCandidateVotesAt(0, 1, afterFirst) == 5);
+    assert(manager.getCandidateVotesAt("D1", "C1", beforeReset) == 25);
+    assert(manager.getDistrictTotalVotesAt(1, afterFirst + 1) == 34);
+    assert(manager.getDistrictTotalVotesAt(1, beforeReset + 1) == 0);
+    assert(manager.getCandidateVotesAt(1, 2, manager.getCurrentVersion()) == manager.getCandidateVotes(1, 2));
+    
+    manager.compactVersions(beforeReset);
+    assert(manager.getOldestVersion() == beforeReset);
+    assert(manager.getCandidateVotesAt(0, 1, beforeReset) == 25);
+    
+    // Clock times map to versions: "results as of 21:30"
+    VoteManager timed;
+    timed.addDistrict(District("North", "D1", 2));
+    timed.addCandidate(Candidate("Alice", "A", "C1"));
+    timed.addCandidate(Candidate("Bob", "B", "C2"));
+    timed.assignCandidateToDistrict(0, 0);
+    timed.assignCandidateToDistrict(0, 1);
+    timed.enableVersionTracking();
+    int64_t nine = 0;
+    assert(VoteHistory::parseClockTime("Tue Nov  5 21:00:00 2024", nine));
+    const int64_t minute = int64_t(60) * 1000000000;
+    timed.addVotes(0, 0, 100, "P1", nine);
+    timed.addVotes(0, 1, 80, "P2", "Tue Nov  5 21:15:00 2024");
+    uint64_t quarterPast = timed.getCurrentVersion();
+    timed.addVotes(0, 1, 7, "P3", "unstamped feed");
+    timed.addVotesBatch(0, {{0, 5}, {1, 50}}, "P4", nine + 45 * minute);
+    timed.addVotes(0, 0, 1, "P5", nine + 40 * minute);  // Late stamp: counts at 21:45
+    
+    assert(timed.getVersionAt(nine - 1) == 0);
+    assert(timed.getVersionAt(nine) == 1);
+    assert(timed.getVersionAt("Tue Nov  5 21:30:00 2024") == quarterPast);
+    assert(timed.getCandidateVotesAt(0, 1, timed.getVersionAt("Tue Nov  5 21:30:00 2024")) == 80);
+    assert(timed.getVersionAt(nine + 45 * minute) == timed.getCurrentVersion());
+    assert(timed.getCandidateVotesAt(0, 1, timed.getVersionAt(nine + 50 * minute)) == 137);
+    threw = false;
+    try {
+        timed.getVersionAt("half past nine");
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    
+    timed.compactVersions(quarterPast);
+    assert(timed.getVersionAt(nine) == quarterPast);
+    assert(timed.getVersionAt(nine + 50 * minute) == timed.getCurrentVersion());
+    
+    std::cout << "✓ Point-in-time query tests passed!\n\n";
+}
+
+void testColumnarHistory() {
+    std::cout << "Testing columnar vote history...\n";
+    
+    // ctime text round-trips through nanoseconds; other labels are kept verbatim
+    int64_t nanoseconds = 0;
+    assert(VoteHistory::parseClockTime("Tue Nov  5 21:30:00 2024", nanoseconds));
+    assert(nanoseconds % 1000000000 == 0);
+    assert(VoteHistory::formatClockTime(nanoseconds) == "Tue Nov  5 21:30:00 2024");
+    assert(!VoteHistory::parseClockTime("t0", nanoseconds));
+    assert(!VoteHistory::parseClockTime("Tue Nov  5 21:30:00 2024 extra", nanoseconds));
+    
+    // Times before 1970 are negative nanoseconds, not label codes
+    int64_t moonLanding = 0;
+    assert(VoteHistory::parseClockTime("Sun Jul 20 20:17:40 1969", moonLanding));
+    assert(moonLanding < 0 && !VoteHistory::isLabel(moonLanding));
+    assert(VoteHistory::formatClockTime(moonLanding) == "Sun Jul 20 20:17:40 1969");
+    int64_t epoch = 0;
+    assert(VoteHistory::parseClockTime("Thu Jan  1 00:00:00 1970", epoch));
+    assert(VoteHistory::formatClockTime(epoch - 1) == "Wed Dec 31 23:59:59 1969");
+    
+    VoteManager manager;
+    DistrictHandle north = manager.addDistrict(District("North", "D1", 3));
+    CandidateHandle alice = manager.addCandidate(Candidate("Alice", "A", "C1"));
+    CandidateHandle bob = manager.addCandidate(Candidate("Bob", "B", "C2"));
+    manager.assignCandidateToDistrict(north, alice);
+    manager.assignCandidateToDistrict(north, bob);
+    
+    manager.addVotes(north, alice, 10, "P1", "Tue Nov  5 21:30:00 2024");
+    manager.addVotes(north, bob, 4, "P2", "batch-7");
+    manager.addVotesBatch(north, {{alice, 1}, {bob, 2}}, "P1", nanoseconds + 1500000000);
+    
+    // Only codes encodeTimestamp handed out are accepted as labels
+    const VoteHistory& labels = manager.getVoteHistory().columns();
+    assert(!labels.isValidTimestamp(INT64_MIN + 5));
+    assert(manager.tryAddVotes(north, alice, 1, "P1", INT64_MIN + 5) == VoteStatus::InvalidTimestamp);
+    bool threw = false;
+    try {
+        labels.formatTimestamp(INT64_MIN + 5);
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    assert(threw);
+    
+    VoteHistoryView history = manager.getVoteHistory();
+    assert(history.size() == 4);
+    VoteUpdate first = history[0];
+    assert(first.districtId == "D1" && first.candidateId == "C1");
+    assert(first.voteCount == 10 && first.precinctId == "P1");
+    assert(first.timestamp == "Tue Nov  5 21:30:00 2024");
+    assert(history[1].timestamp == "batch-7");
+    assert(history.back().timestamp == "Tue Nov  5 21:30:01 2024");
+    assert(history.back().candidateId == "C2" && history.back().voteCount == 2);
+    
+    // Columns hold handles and interned ids, not strings
+    const VoteHistory& columns = history.columns();
+    assert(columns.precincts()[0] == columns.precincts()[2]);
+    assert(columns.precincts()[0] != columns.precincts()[1]);
+    assert(columns.timestamps()[0] == nanoseconds);
+    const int64_t expectedDeltas[] = {10, 4, 1, 2};
+    for (size_t i = 0; i < history.size(); ++i) {
+        assert(columns.deltas()[i] == expectedDeltas[i]);
+    }
+    
+    int64_t replayed = 0;
+    for (const VoteUpdate& update : history) {
+        replayed += update.voteCount;
+    }
+    assert(replayed == manager.getDistrictTotalVotes(north));
+    
+    manager.resetVotes();
+    assert(manager.getVoteHistory().empty());
+    
+    // The update clock is monotonic and close to wall-clock time
+    int64_t wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    int64_t previous = VoteHistory::nowNanoseconds();
+    assert(previous > wallNs - 1000000000 && previous < wallNs + 1000000000);
+    for (int i = 0; i < 1000; ++i) {
+        int64_t next = VoteHistory::nowNanoseconds();
+        assert(next >= previous);
+        previous = next;
+    }
+    
+    // ElectionSystem stamps updates with it and formats only when history is read
+    ElectionSystem election("Clock Test", "2024-11-05");
+    election.setupElection({"North"}, {"Alice"}, {"Party A"});
+    election.setElectionStatus(true);
+    assert(election.processVoteUpdate("North", "Alice", 5, "P1"));
+    const VoteHistory& stamped = election.getVoteManager()->getVoteHistory().columns();
+    assert(stamped.timestamps()[0] >= wallNs - 1000000000);
+    std::string text = election.getVoteHistory()[0].timestamp;
+    assert(text == VoteHistory::formatClockTime(stamped.timestamps()[0]));
+    int64_t parsed;
+    assert(VoteHistory::parseClockTime(text, parsed));
+    
+    std::cout << "✓ Columnar history tests passed!\n\n";
+}
+
+void testChunkedHistory() {
+    std::cout << "Testing chunked history storage...\n";
+    
+    // Elements never move as the array grows across chunks and pages
+    ChunkedArray<int64_t, 2> small;
+    small.slot(0) = 7;
+    const int64_t* firstElement = &small[0];
+    for (size_t i = 1; i < 10000; ++i) {
+        small.slot(i) = static_cast<int64_t>(i) * 3;
+    }
+    assert(&small[0] == firstElement && small[0] == 7);
+    assert(small[9999] == 29997);
+    ChunkedArray<int64_t, 2> copy(small);
+    assert(copy[9999] == 29997 && &copy[0] != firstElement);
+    
+    // Writers append concurrently; the reader only ever sees complete rows
+    const uint32_t writers = 4;
+    const uint32_t rowsPerWriter = 20000;
+    VoteHistory history;
+    std::atomic<bool> done(false);
+    std::thread reader([&]() {
+        size_t checked = 0;
+        while (!done.load(std::memory_order_acquire)) {
+            size_t visible = history.size();
+            for (; checked < visible; ++checked) {
+                int64_t expected = static_cast<int64_t>(history.districts()[checked]) * rowsPerWriter +
+                                   history.candidates()[checked];
+                assert(history.deltas()[checked] == expected);
+                assert(history.timestamps()[checked] == expected);
+            }
+        }
+    });
+    
+    std::vector<std::thread> threads;
+    for (uint32_t w = 0; w < writers; ++w) {
+        threads.emplace_back([&, w]() {
+            for (uint32_t i = 0; i < rowsPerWriter; i += 4) {
+                // Mix single appends with small reserved blocks
+                if (i % 8 == 0) {
+                    for (uint32_t k = i; k < i + 4; ++k) {
+                        int64_t value = static_cast<int64_t>(w) * rowsPerWriter + k;
+                        history.append(w, k, value, 0, value);
+                    }
+                } else {
+                    size_t row = history.reserveRows(4);
+                    for (uint32_t k = 0; k < 4; ++k) {
+                        int64_t value = static_cast<int64_t>(w) * rowsPerWriter + i + k;
+                        history.setRow(row + k, w, i + k, value, 0, value);
+                    }
+                    history.publishRows(row, 4);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+    
+    assert(history.size() == writers * rowsPerWriter);
+    std::vector<uint32_t> perWriter(writers, 0);
+    int64_t sum = 0;
+    for (size_t row = 0; row < history.size(); ++row) {
+        ++perWriter[history.districts()[row]];
+        sum += history.deltas()[row];
+    }
+    for (uint32_t count : perWriter) {
+        assert(count == rowsPerWriter);
+    }
+    int64_t n = static_cast<int64_t>(writers) * rowsPerWriter;
+    assert(sum == n * (n - 1) / 2);
+    
+    // Clearing keeps the chunks; rows written afterwards start at zero
+    history.clear();
+    assert(history.empty());
+    history.append(1, 2, 3, history.internPrecinct("P1"), 4);
+    assert(history.size() == 1 && history.deltas()[0] == 3);
+    
+    // A reservation that cannot be allocated claims nothing, so appends continue
+    bool threw = false;
+    try {
+        history.reserveRows(std::numeric_limits<size_t>::max() / 2);
+    } catch (const std::length_error&) {
+        threw = true;
+    }
+    assert(threw);
+    history.append(5, 6, 7, 0, 8);
+    assert(history.size() == 2 && history.deltas()[1] == 7);
+    
+    VoteHistory moved(std::move(history));
+    assert(moved.size() == 2 && moved.getPrecinctId(moved.precincts()[0]) == "P1");
+    
+    std::cout << "✓ Chunked history tests passed!\n\n";
+}
+
+void testWriteAheadLog() {
+    std::cout << "Testing write-ahead log and recovery...\n";
+    
+    // Standard CRC32C check value
+    assert(crc32c("123456789", 9) == 0xE3069283u);
+    
+    const std::string path = "test_election_wal.log";
+    std::remove(path.c_str());
+    
+    auto setup = [](VoteManager& manager) {
+        for (int d = 0; d < 4; ++d) {
+            manager.addDistrict(District("District " + std::to_string(d), "D" + std::to_string(d), 20));
+        }
+        for (int c = 0; c < 20; ++c) {
+            manager.addCandidate(Candidate("Candidate " + std::to_string(c), "Party", "C" + std::to_string(c)));
+            for (DistrictHandle d = 0; d < 4; ++d) {
+                manager.assignCandidateToDistrict(d, c);
+            }
+        }
+    };
+    
+    const int updates = 10000;
+    std::string expectedResults;
+    std::vector<VoteUpdate> expectedHistory;
+    {
+        VoteManager manager;
+        setup(manager);
+        WalOptions options;
+        options.flushWindow = std::chrono::milliseconds(5);
+        manager.enableWriteAheadLog(path, options);
+        
+        manager.addVotes(0, 1, 999, "P0", "before reset");
+        manager.resetVotes();
+        std::mt19937 gen(1717);
+        for (int i = 0; i < updates; ++i) {
+            manager.addVotes(gen() % 4, gen() % 20, 1 + gen() % 9, "P" + std::to_string(gen() % 50),
+                             static_cast<int64_t>(1700000000) * 1000000000 + i);
+        }
+        manager.addVotesBatch(2, {{3, 40}, {4, 2}}, "P-batch", "Tue Nov  5 21:30:00 2024");
+        manager.addVotes(1, 5, 7, "P-label", "late-night feed");
+        manager.addVotes(1, 6, 3, "P-old", static_cast<int64_t>(-86400) * 1000000000 - 1);
+        manager.addVotes(1, 7, 2, "P-old", "Sun Jul 20 20:17:40 1969");
+        
+        // Group commit: far fewer syncs than updates
+        WriteAheadLog* wal = manager.getWriteAheadLog();
+        wal->flush();
+        assert(wal->getDurableSequence() == wal->getLastSequence());
+        assert(wal->getLastSequence() == static_cast<uint64_t>(updates + 6));
+        assert(wal->getSyncCount() < static_cast<uint64_t>(updates) / 10);
+        
+        expectedResults = manager.getDetailedResults();
+        VoteHistoryView history = manager.getVoteHistory();
+        expectedHistory.assign(history.begin(), history.end());
+    }
+    
+    // A fresh process rebuilds the same tallies and history from the log
+    {
+        VoteManager recovered;
+        setup(recovered);
+        WalReadResult result = recovered.recoverFromLog(path);
+        assert(!result.tornTail);
+        assert(result.records == static_cast<uint64_t>(updates + 6));
+        assert(recovered.getDetailedResults() == expectedResults);
+        VoteHistoryView history = recovered.getVoteHistory();
+        assert(history.size() == expectedHistory.size());
+        for (size_t i = 0; i < history.size(); ++i) {
+            assert(history[i].candidateId == expectedHistory[i].candidateId);
+            assert(history[i].precinctId == expectedHistory[i].precinctId);
+            assert(history[i].timestamp == expectedHistory[i].timestamp);
+            assert(history[i].voteCount == expectedHistory[i].voteCount);
+        }
+    }
+    
+    // A batch is one record carrying every entry
+    size_t batches = 0;
+    WriteAheadLog::read(path, [&](const WalRecord& record) {
+        if (record.type == WalRecord::Type::Batch) {
+            ++batches;
+            assert(record.district == 2 && record.entries.size() == 2);
+            assert(record.entries[0].precinctId == "P-batch" && record.entries[1].delta == 2);
+            assert(record.entries[1].candidate == 4 && record.timestampLabel.empty());
+        }
+    });
+    assert(batches == 1);
+    
+    // A torn final record is ignored on read and cut off when the log is reopened
+    std::string contents;
+    {
+        std::ifstream in(path, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(contents.data(), static_cast<std::streamsize>(contents.size() - 5));
+    }
+    WalReadResult torn = WriteAheadLog::read(path, [](const WalRecord&) {});
+    assert(torn.tornTail);
+    assert(torn.records == static_cast<uint64_t>(updates + 5));
+    {
+        WriteAheadLog wal(path);
+        assert(wal.getLastSequence() == torn.lastSequence);
+        uint64_t sequence = wal.appendVote(0, 0, 1, "P9", 0);
+        wal.waitDurable(sequence);
+    }
+    WalReadResult repaired = WriteAheadLog::read(path, [](const WalRecord&) {});
+    assert(!repaired.tornTail);
+    assert(repaired.records == torn.records + 1);
+    assert(repaired.lastSequence == torn.lastSequence + 1);
+    
+    // A torn precinct report is dropped whole, never half-applied
+    std::remove(path.c_str());
+    {
+        VoteManager manager;
+        setup(manager);
+        manager.enableWriteAheadLog(path);
+        manager.addVotes(0, 0, 1, "P1", int64_t(1));
+        assert(manager.applyPrecinctReport(3, "P7", {{1, 10}, {2, 20}, {3, 30}}, int64_t(2)) == VoteStatus::Ok);
+        manager.getWriteAheadLog()->flush();
+    }
+    {
+        std::ifstream in(path, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(contents.data(), static_cast<std::streamsize>(contents.size() - 20));
+    }
+    {
+        VoteManager recovered;
+        setup(recovered);
+        WalReadResult result = recovered.recoverFromLog(path);
+        assert(result.tornTail && result.records == 1);
+        assert(recovered.getDistrictTotalVotes(3) == 0);
+        assert(recovered.getVoteHistory().size() == 1);
+    }
+    
+    std::remove(path.c_str());
+    std::cout << "✓ Write-ahead log tests passed!\n\n";
+}
+
+void testCheckpointRestart() {
+    std::cout << "Testing checkpoints and log tail replay...\n";
+    
+    const std::string walPath = "test_election_ckpt.log";
+    const std::string checkpointPath = "test_election.ckpt";
+    std::remove(walPath.c_str());
+    std::remove(checkpointPath.c_str());
+    
+    std::string expectedResults;
+    std::vector<VoteUpdate> expectedHistory;
+    uint64_t checkpointSequence;
+    uint64_t lastSequence;
+    uint64_t expectedVersion;
+    {
+        VoteManager manager;
+        for (int d = 0; d < 6; ++d) {
+            manager.addDistrict(District("District " + std::to_string(d), "D" + std::to_string(d), 8));
+        }
+        for (int c = 0; c < 8; ++c) {
+            manager.addCandidate(Candidate("Candidate " + std::to_string(c), "Party", "C" + std::to_string(c)));
+            for (DistrictHandle d = 0; d < 6; ++d) {
+                if ((c + d) % 3 != 0) {
+                    manager.assignCandidateToDistrict(d, c);
+                }
+            }
+        }
+        WalOptions options;
+        options.flushWindow = std::chrono::milliseconds(1);
+        manager.enableWriteAheadLog(walPath, options);
+        manager.enableCheckpoints(checkpointPath, 1000);
+        
+        std::mt19937 gen(1818);
+        auto randomUpdate = [&](int i) {
+            DistrictHandle d = gen() % 6;
+            CandidateHandle c = gen() % 8;
+            if ((c + d) % 3 == 0) {
+                c = (c + 1) % 8;
+            }
+            manager.addVotes(d, c, 1 + gen() % 9, "P" + std::to_string(gen() % 30),
+                             static_cast<int64_t>(1700000000) * 1000000000 + i);
+        };
+        for (int i = 0; i < 3000; ++i) {
+            randomUpdate(i);
+        }
+        manager.addVotes(1, 1, 5, "P-label", "late-night feed");
+        manager.getCheckpointWriter()->wait();
+        checkpointSequence = manager.getCheckpointWriter()->getWrittenSequence();
+        assert(checkpointSequence == 3000);
+        
+        // This tail is only in the log
+        for (int i = 0; i < 250; ++i) {
+            randomUpdate(3000 + i);
+        }
+        manager.getWriteAheadLog()->flush();
+        lastSequence = manager.getWriteAheadLog()->getLastSequence();
+        expectedVersion = manager.getCurrentVersion();
+        expectedResults = manager.getDetailedResults();
+        VoteHistoryView history = manager.getVoteHistory();
+        expectedHistory.assign(history.begin(), history.end());
+    }
+    
+    // Restart: no setup, only the tail after the checkpoint is replayed
+    {
+        VoteManager restored;
+        WalReadResult tail = restored.restoreFromCheckpoint(checkpointPath, walPath);
+        assert(tail.records == lastSequence - checkpointSequence);
+        assert(!tail.tornTail);
+        assert(restored.getCurrentVersion() == expectedVersion);
+        assert(restored.getDistricts().size() == 6);
+        assert(restored.getDetailedResults() == expectedResults);
+        VoteHistoryView history = restored.getVoteHistory();
+        assert(history.size() == expectedHistory.size());
+        for (size_t i = 0; i < history.size(); ++i) {
+            assert(history[i].districtId == expectedHistory[i].districtId);
+            assert(history[i].candidateId == expectedHistory[i].candidateId);
+            assert(history[i].precinctId == expectedHistory[i].precinctId);
+            assert(history[i].timestamp == expectedHistory[i].timestamp);
+            assert(history[i].voteCount == expectedHistory[i].voteCount);
+        }
+        
+        bool threw = false;
+        try {
+            restored.restoreFromCheckpoint(checkpointPath, walPath);
+        } catch (const std::logic_error&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+    
+    // A damaged checkpoint is rejected rather than half-loaded
+    {
+        std::fstream file(checkpointPath, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(40);
+        file.put('\x7f');
+    }
+    {
+        VoteManager restored;
+        bool threw = false;
+        try {
+            restored.restoreFromCheckpoint(checkpointPath, walPath);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+    std::remove(walPath.c_str());
+    std::remove(checkpointPath.c_str());
+    
+    // A captured checkpoint shares the history, yet later appends and resets leave it intact
+    {
+        VoteManager manager;
+        DistrictHandle north = manager.addDistrict(District("North", "N", 2));
+        manager.addCandidate(Candidate("Alice", "A", "C1"));
+        manager.assignCandidateToDistrict(north, 0);
+        for (int i = 0; i < 5000; ++i) {
+            manager.addVotes(north, 0, 1, "P" + std::to_string(i % 7), "label-" + std::to_string(i % 3));
+        }
+        std::shared_ptr<CheckpointData> captured = manager.captureCheckpoint();
+        const VoteHistory& live = manager.getVoteHistory().columns();
+        assert(&captured->history.deltas()[0] == &live.deltas()[0]);
+        
+        for (int i = 0; i < 5000; ++i) {
+            manager.addVotes(north, 0, 2, "Q" + std::to_string(i % 11), "other-label");
+        }
+        manager.resetVotes();
+        manager.addVotes(north, 0, 9, "R1", "after reset");
+        assert(manager.getVoteHistory().columns().deltas()[0] == 9);
+        
+        const VoteHistory& history = captured->history;
+        assert(history.size() == 5000);
+        assert(history.getPrecinctIdCount() == 7 && history.getTimestampLabelCount() == 3);
+        int64_t sum = 0;
+        for (size_t row = 0; row < history.size(); ++row) {
+            sum += history.deltas()[row];
+        }
+        assert(sum == 5000);
+        assert(history.formatTimestamp(history.timestamps()[4]) == "label-1");
+        assert(captured->districts[north].values[0] == 5000);
+        
+        writeCheckpointFile(checkpointPath, *captured);
+        CheckpointData reread = readCheckpointFile(checkpointPath);
+        assert(reread.history.size() == 5000);
+        assert(reread.history.getPrecinctId(reread.history.precincts()[6]) == "P6");
+        std::remove(checkpointPath.c_str());
+    }
+    
+    // Restart time for a 100k-district election
+    {
+        const int districtCount = 100000;
+        VoteManager manager;
+        for (int c = 0; c < 3; ++c) {
+            manager.addCandidate(Candidate("Candidate " + std::to_string(c), "Party", "C" + std::to_string(c)));
+        }
+        for (int d = 0; d < districtCount; ++d) {
+            DistrictHandle handle = manager.addDistrict(District("District " + std::to_string(d),
+                                                                 "D" + std::to_string(d), 3));
+            for (CandidateHandle c = 0; c < 3; ++c) {
+                manager.assignCandidateToDistrict(handle, c);
+            }
+            manager.addVotesBatch(handle, {{0, d % 7}, {1, d % 5}, {2, d % 3}}, "P", int64_t(0));
+        }
+        manager.writeCheckpoint(checkpointPath);
+        
+        auto start = std::chrono::steady_clock::now();
+        VoteManager restored;
+        restored.restoreFromCheckpoint(checkpointPath, walPath);
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        std::cout << "Restored " << districtCount << " districts in " << elapsed.count() << " ms\n";
+        
+        for (CandidateHandle c = 0; c < 3; ++c) {
+            assert(restored.getCandidateTotalVotes(c) == manager.getCandidateTotalVotes(c));
+        }
+        assert(restored.getDistrictLeader(static_cast<DistrictHandle>(99999)) ==
+               manager.getDistrictLeader(static_cast<DistrictHandle>(99999)));
+        assert(restored.getVoteHistory().size() == manager.getVoteHistory().size());
+        std::remove(checkpointPath.c_str());
+    }
+    
+    std::cout << "✓ Checkpoint tests passed!\n\n";
+}
+
+void testMappedTallies() {
+    std::cout << "Testing memory-mapped tallies...\n";
+    
+    const std::string path = "test_election_tallies.map";
+    std::remove(path.c_str());
+    
+    auto setup = [](VoteManager& manager) {
+        manager.addDistrict(District("North", "N", 3));
+        manager.addDistrict(District("South", "S", 40));
+        for (int c = 0; c < 40; ++c) {
+            manager.addCandidate(Candidate("Candidate " + std::to_string(c), "Party", "C" + std::to_string(c)));
+            manager.assignCandidateToDistrict(1, c);
+        }
+        for (CandidateHandle c = 0; c < 3; ++c) {
+            manager.assignCandidateToDistrict(0, c);
+        }
+    };
+    
+    std::string expectedResults;
+    std::string expectedLeader;
+    uint64_t expectedCommits;
+    {
+        VoteManager manager(path);
+        assert(manager.getTallyStorage() == TallyStorage::Mapped);
+        setup(manager);
+        std::mt19937 gen(1919);
+        for (int i = 0; i < 2000; ++i) {
+            DistrictHandle d = gen() % 2;
+            manager.addVotes(d, gen() % (d == 0 ? 3 : 40), 1 + gen() % 9, "P", int64_t(0));
+        }
+        manager.addVotesBatch(1, {{7, 500}, {8, 20}}, "P", int64_t(0));
+        expectedCommits = manager.getMappedTallyStore()->getCommitCount();
+        assert(expectedCommits == manager.getCurrentVersion());
+        expectedResults = manager.getDetailedResults();
+        expectedLeader = manager.getOverallLeader();
+    }
+    
+    // Reopen: the same setup reattaches the rows and queries are live at once
+    {
+        VoteManager reopened(path);
+        setup(reopened);
+        assert(reopened.getMappedTallyStore()->getCommitCount() == expectedCommits);
+        assert(reopened.getDetailedResults() == expectedResults);
+        assert(reopened.getOverallLeader() == expectedLeader);
+        assert(reopened.getDistrictLeader("S") != "");
+        reopened.addVotes(0, 2, 10, "P", int64_t(0));
+        assert(reopened.getMappedTallyStore()->getCommitCount() == expectedCommits + 1);
+    }
+    
+    // A different district layout is rejected
+    {
+        VoteManager mismatched(path);
+        mismatched.addDistrict(District("North", "N", 3));
+        bool threw = false;
+        try {
+            mismatched.addDistrict(District("South", "S", 41));
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+    std::remove(path.c_str());
+    
+#ifndef _WIN32
+    // Kill a writer in the middle of its batches: every batch adds 1 to every
+    // slot, so a consistent file has all slots equal to the commit count
+    const size_t slots = 1 << 16;
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        std::remove(path.c_str());
+        int ready[2];
+        assert(pipe(ready) == 0);
+        pid_t child = fork();
+        assert(child >= 0);
+        if (child == 0) {
+            try {
+                MappedTallyStore store(path);
+                store.addDistrict(slots);
+                std::vector<int64_t> ones(slots, 1);
+                store.applyDenseBatch(0, ones);
+                char byte = 1;
+                if (write(ready[1], &byte, 1) != 1) {
+                    _exit(1);
+                }
+                for (;;) {
+                    store.applyDenseBatch(0, ones);
+                }
+            } catch (...) {
+                _exit(1);
+            }
+        }
+        
+        char byte;
+        assert(read(ready[0], &byte, 1) == 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20 + 7 * attempt));
+        kill(child, SIGKILL);
+        int status;
+        waitpid(child, &status, 0);
+        assert(WIFSIGNALED(status));
+        close(ready[0]);
+        close(ready[1]);
+        
+        MappedTallyStore store(path);
+        store.addDistrict(slots);
+        uint64_t commits = store.getCommitCount();
+        assert(commits >= 1);
+        std::vector<int64_t> values;
+        store.readDistrict(0, values);
+        for (int64_t value : values) {
+            assert(value == static_cast<int64_t>(commits));
+        }
+        assert(store.getDistrictTotal(0) == static_cast<int64_t>(commits * slots));
+        std::cout << "Recovered " << commits << " whole batches after SIGKILL\n";
+    }
+    std::remove(path.c_str());
+#endif
+    
+    std::cout << "✓ Mapped tally tests passed!\n\n";
+}
 
 void testEdgeCases() {
     std::cout << "Testing edge cases...\n";
@@ -165,6 +2045,9 @@ void testEdgeCases() {
     std::cout << "Invalid candidate result: " << (result ? "SUCCESS" : "FAILED (expected)") << "\n";
     assert(!result);
     
+    assert(election.getDistrictResults("Invalid District").find("District not found") == 0);
+    assert(election.getCandidateResults("Invalid Candidate").find("Candidate not found") == 0);
+    
     std::cout << "✓ Edge case tests passed!\n\n";
 }
 
@@ -174,6 +2057,27 @@ int main() {
     try {
         testBasicElection();
         testPerformance();
+        testHandleApi();
+        testTallyStorageBackends();
+        testLeaderTracking();
+        testBatchApply();
+        testBulkConstruction();
+        testTemplatedFenwick();
+        testFixedFenwick();
+        testSmallRaceKernels();
+        testConcurrentFenwick();
+        testShardedIngestion();
+        testBatchVoteUpdates();
+        testAsyncIngestion();
+        testSnapshots();
+        testPrecinctReports();
+        testPrecinctIndex();
+        testPointInTimeQueries();
+        testColumnarHistory();
+        testChunkedHistory();
+        testWriteAheadLog();
+        testCheckpointRestart();
+        testMappedTallies();
         testEdgeCases();
         
         std::cout << "All tests passed successfully!\n";